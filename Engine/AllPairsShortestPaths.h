@@ -0,0 +1,233 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include "CsrGraph.h"
+#include "ThreadPool.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define APSP_USE_SSE2 1
+#endif
+
+// distance and next hop between every pair of vertices of a small graph
+// once built any path is read off in O(path length) by following next hops
+// meant for graphs of up to a few thousand vertices, the two matrices take
+// 8 bytes per pair
+class AllPairsShortestPaths
+{
+public:
+	// ctor, holds no vertices
+	AllPairsShortestPaths() = default;
+	// weighted shortest paths of g using blocked floyd-warshall
+	// weights must not be negative
+	template <typename V>
+	explicit AllPairsShortestPaths(const Graph<V>& g)
+		:
+		AllPairsShortestPaths(CsrGraph(g))
+	{}
+	// weighted shortest paths of g using blocked floyd-warshall
+	// weights must not be negative
+	explicit AllPairsShortestPaths(const CsrGraph& g)
+	{
+		Init(g.NumVertices());
+		for (size_t u = 0; u < n; u++)
+		{
+			for (size_t k = g.EdgesBegin(u); k < g.EdgesEnd(u); k++)
+			{
+				assert(g.Weight(k) >= 0.0f && "Negative edge weight");
+				const size_t v = g.Target(k);
+				float& d = dist[u * stride + v];
+				if (g.Weight(k) < d)
+				{
+					d = g.Weight(k);
+					next[u * stride + v] = uint32_t(v);
+				}
+			}
+		}
+		FloydWarshall();
+	}
+	// fewest edge paths of g using one bredth first search per vertex
+	// spread over the pool, weights are ignored and distances are hop counts
+	static AllPairsShortestPaths FromBFS(const CsrGraph& g, ThreadPool& pool)
+	{
+		AllPairsShortestPaths res;
+		res.Init(g.NumVertices());
+		const size_t n = res.n;
+
+		pool.ParallelFor(n, 1, [&](size_t, size_t begin, size_t end)
+		{
+			DSA<size_t> q(n);
+			for (size_t src = begin; src < end; src++)
+			{
+				float* const d = res.dist.data() + src * res.stride;
+				uint32_t* const first_hop = res.next.data() + src * res.stride;
+				size_t head = 0, tail = 0;
+				q[tail++] = src;
+				while (head < tail)
+				{
+					const size_t cur = q[head++];
+					for (size_t k = g.EdgesBegin(cur); k < g.EdgesEnd(cur); k++)
+					{
+						const size_t nbr = g.Target(k);
+						if (d[nbr] == Infinity)
+						{
+							d[nbr] = d[cur] + 1.0f;
+							// the first hop towards nbr is nbr itself for
+							// neighbours of src, otherwise the same as cur's
+							first_hop[nbr] = cur == src ? uint32_t(nbr) : first_hop[cur];
+							q[tail++] = nbr;
+						}
+					}
+				}
+			}
+		});
+		return res;
+	}
+
+	// num of vertices in the graph
+	size_t NumVertices() const
+	{
+		return n;
+	}
+	// length of the shortest path from the src idx to the dst idx
+	// infinity if dst is unreachable
+	float Distance(size_t src_idx, size_t dst_idx) const
+	{
+		assert(src_idx < n && dst_idx < n && "Vertex does not exist");
+		return dist[src_idx * stride + dst_idx];
+	}
+	// the vertex after src on the shortest path from src to dst
+	// dst if src == dst, n if dst is unreachable
+	size_t NextHop(size_t src_idx, size_t dst_idx) const
+	{
+		assert(src_idx < n && dst_idx < n && "Vertex does not exist");
+		const uint32_t hop = next[src_idx * stride + dst_idx];
+		return hop == NoHop ? n : size_t(hop);
+	}
+	// shortest path from the src idx to the dst idx, empty if unreachable
+	DSA<size_t> Path_idx(size_t src_idx, size_t dst_idx) const
+	{
+		if (NextHop(src_idx, dst_idx) == n)
+		{
+			return DSA<size_t>();
+		}
+		DSA<size_t> path(1, src_idx);
+		for (size_t v = src_idx; v != dst_idx; v = NextHop(v, dst_idx))
+		{
+			path.push_back(NextHop(v, dst_idx));
+		}
+		return path;
+	}
+
+private:
+	// allocates the matrices with nothing reachable except every vertex from itself
+	void Init(size_t num_verts)
+	{
+		assert(num_verts < NoHop && "Too many vertices");
+		n = num_verts;
+		// padding rows to a whole num of blocks keeps every block full
+		stride = (n + Block - 1) / Block * Block;
+		const float inf = Infinity;
+		const uint32_t no_hop = NoHop;
+		dist = DSA<float>(stride * stride, inf);
+		next = DSA<uint32_t>(stride * stride, no_hop);
+		for (size_t v = 0; v < n; v++)
+		{
+			dist[v * stride + v] = 0.0f;
+			next[v * stride + v] = uint32_t(v);
+		}
+	}
+	// relaxes every pair through every intermediate vertex, one Block x Block
+	// tile at a time so the three tiles in use stay in cache
+	// for each diagonal tile kb the tile itself is done first, then the rest
+	// of its row and column, then every other tile, which only reads tiles
+	// that are already final for the intermediates in kb
+	void FloydWarshall()
+	{
+		const size_t blocks = stride / Block;
+		for (size_t kb = 0; kb < blocks; kb++)
+		{
+			UpdateTile(kb, kb, kb);
+			for (size_t b = 0; b < blocks; b++)
+			{
+				if (b != kb)
+				{
+					UpdateTile(kb, b, kb);
+					UpdateTile(b, kb, kb);
+				}
+			}
+			for (size_t ib = 0; ib < blocks; ib++)
+			{
+				for (size_t jb = 0; jb < blocks; jb++)
+				{
+					if (ib != kb && jb != kb)
+					{
+						UpdateTile(ib, jb, kb);
+					}
+				}
+			}
+		}
+	}
+	// dist[i][j] = min(dist[i][j], dist[i][k] + dist[k][j]) over the tile
+	// (ib, jb) for every k in tile kb, taking k's next hop when it wins
+	void UpdateTile(size_t ib, size_t jb, size_t kb)
+	{
+		float* const d = dist.data();
+		uint32_t* const nh = next.data();
+		const size_t j0 = jb * Block;
+		for (size_t k = kb * Block; k < (kb + 1) * Block; k++)
+		{
+			const float* const d_k = d + k * stride + j0;
+			for (size_t i = ib * Block; i < (ib + 1) * Block; i++)
+			{
+				const float d_ik = d[i * stride + k];
+				if (d_ik == Infinity)
+				{
+					continue;
+				}
+				const uint32_t hop_ik = nh[i * stride + k];
+				float* const d_i = d + i * stride + j0;
+				uint32_t* const nh_i = nh + i * stride + j0;
+#ifdef APSP_USE_SSE2
+				const __m128 via_k = _mm_set1_ps(d_ik);
+				const __m128i hop = _mm_set1_epi32(int(hop_ik));
+				for (size_t j = 0; j < Block; j += 4)
+				{
+					const __m128 old = _mm_loadu_ps(d_i + j);
+					const __m128 cand = _mm_add_ps(via_k, _mm_loadu_ps(d_k + j));
+					const __m128i better = _mm_castps_si128(_mm_cmplt_ps(cand, old));
+					_mm_storeu_ps(d_i + j, _mm_min_ps(cand, old));
+					const __m128i old_hop = _mm_loadu_si128(reinterpret_cast<const __m128i*>(nh_i + j));
+					const __m128i new_hop = _mm_or_si128(_mm_and_si128(better, hop), _mm_andnot_si128(better, old_hop));
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(nh_i + j), new_hop);
+				}
+#else
+				for (size_t j = 0; j < Block; j++)
+				{
+					const float cand = d_ik + d_k[j];
+					if (cand < d_i[j])
+					{
+						d_i[j] = cand;
+						nh_i[j] = hop_ik;
+					}
+				}
+#endif
+			}
+		}
+	}
+
+private:
+	// tile size, a multiple of the simd width
+	static constexpr size_t Block = 32;
+	static constexpr uint32_t NoHop = ~uint32_t(0);
+	static constexpr float Infinity = std::numeric_limits<float>::infinity();
+
+private:
+	size_t n = 0;
+	// row length of the matrices, n rounded up to a whole num of tiles
+	size_t stride = 0;
+	// dist[i * stride + j] is the length of the shortest path i -> j
+	DSA<float> dist;
+	// next[i * stride + j] is the vertex after i on that path
+	DSA<uint32_t> next;
+};
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include "DSA.h"
+
+// fixed size set of bits packed into 64 bit words
+// used as a compact visited/membership flag per vertex
+class Bitset
+{
+public:
+	// ctor
+	Bitset() = default;
+	// creates a bitset of given number of bits, all cleared
+	Bitset(size_t size)
+		:
+		num_bits(size),
+		words(NumWords(size), 0)
+	{}
+
+	// true if bit i is set
+	bool test(size_t i) const
+	{
+		assert(i < num_bits);
+		return (words.data()[i >> 6] >> (i & 63)) & 1;
+	}
+	// sets bit i
+	void set(size_t i)
+	{
+		assert(i < num_bits);
+		words.data()[i >> 6] |= uint64_t(1) << (i & 63);
+	}
+	// clears bit i
+	void reset(size_t i)
+	{
+		assert(i < num_bits);
+		words.data()[i >> 6] &= ~(uint64_t(1) << (i & 63));
+	}
+	// sets bit i and returns its previous value
+	bool test_and_set(size_t i)
+	{
+		assert(i < num_bits);
+		uint64_t& w = words.data()[i >> 6];
+		const uint64_t mask = uint64_t(1) << (i & 63);
+		const bool was_set = (w & mask) != 0;
+		w |= mask;
+		return was_set;
+	}
+	// adds a bit at the end
+	void push_back(bool val)
+	{
+		if ((num_bits & 63) == 0)
+		{
+			words.push_back(0);
+		}
+		num_bits++;
+		if (val)
+		{
+			set(num_bits - 1);
+		}
+	}
+	// clears all bits
+	void clear()
+	{
+		for (auto& w : words)
+		{
+			w = 0;
+		}
+	}
+
+	// num of bits in the set
+	size_t size() const
+	{
+		return num_bits;
+	}
+
+private:
+	static size_t NumWords(size_t num_bits)
+	{
+		return (num_bits + 63) / 64;
+	}
+
+private:
+	size_t num_bits = 0;
+	DSA<uint64_t> words;
+};
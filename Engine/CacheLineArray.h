@@ -0,0 +1,83 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+// bytes in a cache line, the unit cores fight over when they write nearby data
+constexpr size_t CacheLineSize = 64;
+
+// fixed size array that gives every element cache lines of its own, for data
+// each thread writes to all the time (per thread buffers, counters, slots)
+// so threads writing their own elements don't invalidate each other's lines
+// new only aligns to 16 bytes before c++17, so the memory is aligned by hand
+template <typename T>
+class CacheLineArray
+{
+	// an element padded up to a whole num of cache lines
+	struct alignas(CacheLineSize) Slot
+	{
+		T value;
+	};
+
+public:
+	// count default constructed elements
+	explicit CacheLineArray(size_t count)
+		:
+		count(count),
+		raw(::operator new(count * sizeof(Slot) + CacheLineSize))
+	{
+		const uintptr_t addr = reinterpret_cast<uintptr_t>(raw);
+		slots = reinterpret_cast<Slot*>((addr + CacheLineSize - 1) / CacheLineSize * CacheLineSize);
+		size_t i = 0;
+		try
+		{
+			for (; i < count; i++)
+			{
+				new (slots + i) Slot();
+			}
+		}
+		catch (...)
+		{
+			Destroy(i);
+			throw;
+		}
+	}
+	CacheLineArray(const CacheLineArray&) = delete;
+	CacheLineArray& operator=(const CacheLineArray&) = delete;
+	~CacheLineArray()
+	{
+		Destroy(count);
+	}
+
+	T& operator[](size_t idx)
+	{
+		assert(idx < count && "Index out of range");
+		return slots[idx].value;
+	}
+	const T& operator[](size_t idx) const
+	{
+		assert(idx < count && "Index out of range");
+		return slots[idx].value;
+	}
+	size_t size() const
+	{
+		return count;
+	}
+
+private:
+	// destroys the first num elements and frees the memory
+	void Destroy(size_t num)
+	{
+		for (size_t i = num; i-- > 0;)
+		{
+			slots[i].~Slot();
+		}
+		::operator delete(raw);
+	}
+
+private:
+	size_t count;
+	void* raw;
+	Slot* slots = nullptr;
+};
@@ -0,0 +1,312 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include "Bitset.h"
+#include "CsrGraph.h"
+#include "ShortestPath.h"
+
+// unweighted csr graph with every adjacency list sorted and gap encoded
+// the first neighbour of v is stored as its signed distance from v and every
+// other as its distance from the one before, each as a varint of 7 bits per
+// byte, so neighbours close to each other take a byte instead of eight
+// lists are decoded on the fly while they are traversed
+class CompressedCsrGraph
+{
+public:
+	// position in the adjacency list of a vertex, for traversals that
+	// have to stop and resume a list
+	struct Cursor
+	{
+		size_t pos;
+		size_t end;
+		// the last neighbour decoded, the vertex itself before the first
+		size_t prev;
+		bool first;
+	};
+
+public:
+	// ctor
+	CompressedCsrGraph()
+		:
+		offsets(1, 0),
+		bytes(0)
+	{}
+	// compresses the adjacency of g, edge weights are dropped
+	explicit CompressedCsrGraph(const CsrGraph& g)
+		:
+		offsets(g.NumVertices() + 1, 0),
+		num_edges(g.NumEdges())
+	{
+		const size_t n = g.NumVertices();
+		DSA<size_t> list(1);
+		for (size_t v = 0; v < n; v++)
+		{
+			const size_t deg = g.Degree(v);
+			if (deg > list.size())
+			{
+				list = DSA<size_t>(deg);
+			}
+			for (size_t i = 0; i < deg; i++)
+			{
+				list[i] = g.Target(g.EdgesBegin(v) + i);
+			}
+			std::sort(list.data(), list.data() + deg);
+
+			size_t prev = v;
+			for (size_t i = 0; i < deg; i++)
+			{
+				const size_t nbr = list[i];
+				if (i == 0)
+				{
+					// zigzag so neighbours just below v stay small too
+					const size_t delta = nbr >= v ? (nbr - v) << 1 : ((v - nbr) << 1) - 1;
+					WriteVarint(delta);
+				}
+				else
+				{
+					WriteVarint(nbr - prev);
+				}
+				prev = nbr;
+			}
+			offsets[v + 1] = bytes.size();
+		}
+
+		// the buffer grew by doubling, copy it into one of the exact size
+		DSA<uint8_t> exact(bytes.size());
+		std::copy(bytes.data(), bytes.data() + bytes.size(), exact.data());
+		bytes = std::move(exact);
+	}
+
+	// num of vertices in the graph
+	size_t NumVertices() const
+	{
+		return offsets.size() - 1;
+	}
+	// num of edges in the graph
+	size_t NumEdges() const
+	{
+		return num_edges;
+	}
+	// num of bytes used by the adjacency
+	size_t SizeInBytes() const
+	{
+		return offsets.size() * sizeof(size_t) + bytes.size();
+	}
+
+	// cursor at the start of the adjacency list of vertex at given idx
+	Cursor Neighbours(size_t idx) const
+	{
+		return Cursor{ offsets[idx], offsets[idx + 1], idx, true };
+	}
+	// decodes the next neighbour into nbr, returns false at the end of the list
+	bool Next(Cursor& c, size_t& nbr) const
+	{
+		if (c.pos == c.end)
+		{
+			return false;
+		}
+		const size_t val = ReadVarint(bytes.data(), c.pos);
+		if (c.first)
+		{
+			nbr = (val & 1) ? c.prev - ((val + 1) >> 1) : c.prev + (val >> 1);
+			c.first = false;
+		}
+		else
+		{
+			nbr = c.prev + val;
+		}
+		c.prev = nbr;
+		return true;
+	}
+	// calls f(nbr) for every neighbour of vertex at given idx in increasing order
+	template <typename F>
+	void ForEachNeighbour(size_t idx, F f) const
+	{
+		Cursor c = Neighbours(idx);
+		size_t nbr;
+		while (Next(c, nbr))
+		{
+			f(nbr);
+		}
+	}
+
+	// performs bredth first search starting at the source idx
+	// until the dst idx is found, returns the shortest path (in edges)
+	// from src to dst or an empty array if dst is unreachable
+	DSA<size_t> BFS_idx(size_t src_idx, size_t dst_idx) const
+	{
+		const size_t n = NumVertices();
+		assert(src_idx < n && "Vertex does not exist");
+		assert(dst_idx < n && "Vertex does not exist");
+
+		Bitset visited(n);
+		DSA<size_t> pred(n);
+		DSA<size_t> q(n);
+		size_t head = 0, tail = 0;
+
+		visited.set(src_idx);
+		pred[src_idx] = src_idx;
+		q[tail++] = src_idx;
+
+		while (head < tail)
+		{
+			const size_t cur = q[head++];
+			if (cur == dst_idx)
+			{
+				return BuildPath(pred, src_idx, dst_idx);
+			}
+
+			Cursor c = Neighbours(cur);
+			size_t nbr;
+			while (Next(c, nbr))
+			{
+				if (!visited.test_and_set(nbr))
+				{
+					pred[nbr] = cur;
+					q[tail++] = nbr;
+				}
+			}
+		}
+
+		return DSA<size_t>();
+	}
+	// performs depth first search starting at the source idx
+	// until the dst idx is found, returns the path from src to dst
+	// or an empty array if dst is unreachable
+	DSA<size_t> DFS_idx(size_t src_idx, size_t dst_idx) const
+	{
+		const size_t n = NumVertices();
+		assert(src_idx < n && "Vertex does not exist");
+		assert(dst_idx < n && "Vertex does not exist");
+
+		if (src_idx == dst_idx)
+		{
+			return DSA<size_t>(1, src_idx);
+		}
+
+		Bitset visited(n);
+		// the current path and where each vertex on it is in its list
+		DSA<size_t> path_verts(n);
+		DSA<Cursor> path_next(n);
+		size_t depth = 0;
+
+		visited.set(src_idx);
+		path_verts[depth] = src_idx;
+		path_next[depth] = Neighbours(src_idx);
+		depth++;
+
+		while (depth > 0)
+		{
+			size_t nbr;
+			// all neighbours explored, backtrack
+			if (!Next(path_next[depth - 1], nbr))
+			{
+				depth--;
+				continue;
+			}
+			if (visited.test_and_set(nbr))
+			{
+				continue;
+			}
+
+			if (nbr == dst_idx)
+			{
+				DSA<size_t> path(depth + 1);
+				for (size_t i = 0; i < depth; i++)
+				{
+					path[i] = path_verts[i];
+				}
+				path[depth] = dst_idx;
+				return path;
+			}
+			path_verts[depth] = nbr;
+			path_next[depth] = Neighbours(nbr);
+			depth++;
+		}
+
+		return DSA<size_t>();
+	}
+	// computes the hop count from the source idx to every vertex
+	// unreachable vertices are given a distance of NumVertices()
+	DSA<size_t> BFS_dist(size_t src_idx) const
+	{
+		const size_t n = NumVertices();
+		assert(src_idx < n && "Vertex does not exist");
+
+		DSA<size_t> dist(n, n);
+		DSA<size_t> q(n);
+		size_t head = 0, tail = 0;
+
+		dist[src_idx] = 0;
+		q[tail++] = src_idx;
+
+		while (head < tail)
+		{
+			const size_t cur = q[head++];
+			const size_t d = dist[cur] + 1;
+			Cursor c = Neighbours(cur);
+			size_t nbr;
+			while (Next(c, nbr))
+			{
+				if (dist[nbr] == n)
+				{
+					dist[nbr] = d;
+					q[tail++] = nbr;
+				}
+			}
+		}
+
+		return dist;
+	}
+
+private:
+	// appends val 7 bits at a time, low bits first, with the top bit
+	// of every byte but the last set
+	void WriteVarint(size_t val)
+	{
+		while (val >= 0x80)
+		{
+			bytes.push_back(uint8_t(val | 0x80));
+			val >>= 7;
+		}
+		bytes.push_back(uint8_t(val));
+	}
+	// reads the varint at pos and moves pos past it
+	static size_t ReadVarint(const uint8_t* p, size_t& pos)
+	{
+		size_t b = p[pos++];
+		// most gaps fit in one byte and nearly all in three
+		if (b < 0x80)
+		{
+			return b;
+		}
+		size_t val = b & 0x7f;
+		b = p[pos++];
+		val |= (b & 0x7f) << 7;
+		if (b < 0x80)
+		{
+			return val;
+		}
+		b = p[pos++];
+		val |= (b & 0x7f) << 14;
+		if (b < 0x80)
+		{
+			return val;
+		}
+		for (unsigned shift = 21;; shift += 7)
+		{
+			b = p[pos++];
+			val |= (b & 0x7f) << shift;
+			if (b < 0x80)
+			{
+				return val;
+			}
+		}
+	}
+
+private:
+	// adjacency list of v is bytes[offsets[v]] .. bytes[offsets[v + 1] - 1]
+	DSA<size_t> offsets;
+	DSA<uint8_t> bytes;
+	size_t num_edges = 0;
+};
@@ -0,0 +1,155 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <utility>
+#include "CsrGraph.h"
+#include "ThreadPool.h"
+
+// disjoint sets of the indices 0 .. size() - 1 that any num of threads
+// can merge and query at once without locks
+// a root is always linked under the smaller of the two roots with a single
+// compare and swap, so parents only ever point to smaller indices and the
+// root of every set is its smallest element
+class ConcurrentUnionFind
+{
+public:
+	// creates size singleton sets
+	explicit ConcurrentUnionFind(size_t size)
+		:
+		parent(new std::atomic<size_t>[size]),
+		num_elems(size)
+	{
+		for (size_t i = 0; i < size; i++)
+		{
+			parent[i].store(i, std::memory_order_relaxed);
+		}
+	}
+
+	// returns the representative of the set containing x
+	// halving the path to it on the way, a failed halving is harmless
+	// since the grandparent is still an ancestor
+	size_t Find(size_t x)
+	{
+		assert(x < num_elems);
+		while (true)
+		{
+			size_t p = parent[x].load(std::memory_order_acquire);
+			if (p == x)
+			{
+				return x;
+			}
+			const size_t gp = parent[p].load(std::memory_order_acquire);
+			if (p != gp)
+			{
+				parent[x].compare_exchange_weak(p, gp, std::memory_order_release, std::memory_order_relaxed);
+			}
+			x = gp;
+		}
+	}
+	// merges the sets containing a and b
+	// returns false if they were already the same set
+	bool Union(size_t a, size_t b)
+	{
+		while (true)
+		{
+			a = Find(a);
+			b = Find(b);
+			if (a == b)
+			{
+				return false;
+			}
+			if (a < b)
+			{
+				std::swap(a, b);
+			}
+			// fails if another thread linked a first, retry from the new roots
+			size_t expected = a;
+			if (parent[a].compare_exchange_strong(expected, b, std::memory_order_acq_rel))
+			{
+				return true;
+			}
+		}
+	}
+	// true if a and b are in the same set
+	bool Connected(size_t a, size_t b)
+	{
+		while (true)
+		{
+			a = Find(a);
+			b = Find(b);
+			if (a == b)
+			{
+				return true;
+			}
+			// a is still a root so the two sets were apart at this point
+			if (parent[a].load(std::memory_order_acquire) == a)
+			{
+				return false;
+			}
+		}
+	}
+
+	// num of elements
+	size_t size() const
+	{
+		return num_elems;
+	}
+
+private:
+	std::unique_ptr<std::atomic<size_t>[]> parent;
+	size_t num_elems;
+};
+
+// the connected components of a graph, ignoring edge directions
+struct Components
+{
+	// label[v] is the smallest vertex idx in v's component
+	DSA<size_t> label;
+	// num of components
+	size_t count = 0;
+
+	// true if a and b are in the same component
+	bool Connected(size_t a, size_t b) const
+	{
+		return label[a] == label[b];
+	}
+};
+
+// finds the connected components of g by merging the ends of every edge
+// with the edges split between the threads of the pool
+inline Components ConnectedComponents(const CsrGraph& g, ThreadPool& pool)
+{
+	const size_t n = g.NumVertices();
+	ConcurrentUnionFind sets(n);
+	constexpr size_t Grain = 256;
+
+	pool.ParallelFor(n, Grain, [&](size_t, size_t begin, size_t end)
+	{
+		for (size_t v = begin; v < end; v++)
+		{
+			for (size_t k = g.EdgesBegin(v); k < g.EdgesEnd(v); k++)
+			{
+				sets.Union(v, g.Target(k));
+			}
+		}
+	});
+
+	Components res;
+	res.label = DSA<size_t>(n);
+	std::atomic<size_t> count(0);
+	pool.ParallelFor(n, Grain, [&](size_t, size_t begin, size_t end)
+	{
+		size_t roots = 0;
+		for (size_t v = begin; v < end; v++)
+		{
+			res.label.data()[v] = sets.Find(v);
+			if (res.label.data()[v] == v)
+			{
+				roots++;
+			}
+		}
+		count.fetch_add(roots, std::memory_order_relaxed);
+	});
+	res.count = count.load();
+	return res;
+}
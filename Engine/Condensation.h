@@ -0,0 +1,243 @@
+#pragma once
+#include "Bitset.h"
+#include "CsrGraph.h"
+
+// the strongly connected components of a directed graph along with the
+// condensation dag that has one vertex per component and an edge between
+// two components wherever an edge of the graph joins them
+// components are numbered in topological order, so every dag edge goes from
+// a smaller component to a larger one and a vertex can only reach vertices
+// whose component is not smaller than its own
+class Condensation
+{
+public:
+	// ctor, holds no vertices
+	Condensation() = default;
+	// decomposes g into its strongly connected components
+	template <typename V>
+	explicit Condensation(const Graph<V>& g)
+		:
+		Condensation(CsrGraph(g))
+	{}
+	// decomposes g into its strongly connected components
+	// using tarjan's algorithm with an explicit stack
+	explicit Condensation(const CsrGraph& g)
+		:
+		comp(g.NumVertices())
+	{
+		const size_t n = g.NumVertices();
+		const size_t emitted = FindComponents(g);
+
+		// tarjan's emits every component after all the components it can
+		// reach, flipping the order makes it topological
+		for (size_t v = 0; v < n; v++)
+		{
+			comp[v] = emitted - 1 - comp[v];
+		}
+
+		// one dag edge per pair of joined components, keeping the lightest
+		// of the edges it stands for
+		// walking the vertices grouped by component gathers all edges leaving
+		// a component together, so last_edge tells if the edge to a target
+		// component has already been added for the current one
+		DSA<CsrGraph::Edge> dag_edges;
+		DSA<size_t> last_edge(emitted, ~size_t(0));
+		DSA<size_t> order = VerticesByComponent(emitted);
+		for (size_t i = 0; i < n;)
+		{
+			const size_t c = comp[order[i]];
+			const size_t first = dag_edges.size();
+			for (; i < n && comp[order[i]] == c; i++)
+			{
+				const size_t u = order[i];
+				for (size_t k = g.EdgesBegin(u); k < g.EdgesEnd(u); k++)
+				{
+					const size_t d = comp[g.Target(k)];
+					if (d == c)
+					{
+						continue;
+					}
+					const size_t seen = last_edge[d];
+					if (seen != ~size_t(0) && seen >= first)
+					{
+						CsrGraph::Edge& e = dag_edges[seen];
+						e.weight = std::min(e.weight, g.Weight(k));
+					}
+					else
+					{
+						last_edge[d] = dag_edges.size();
+						dag_edges.push_back({ c, d, g.Weight(k) });
+					}
+				}
+			}
+		}
+		dag = CsrGraph(emitted, dag_edges);
+	}
+
+	// num of strongly connected components
+	size_t NumComponents() const
+	{
+		return dag.NumVertices();
+	}
+	// the component of the vertex at given idx, which is also
+	// its components position in topological order
+	size_t Component(size_t idx) const
+	{
+		return comp[idx];
+	}
+	// the condensation dag, vertex c stands for component c
+	// edge weights are the lightest of the graph edges they stand for
+	const CsrGraph& Dag() const
+	{
+		return dag;
+	}
+
+	// true if there is a directed path from the src idx to the dst idx
+	// only components between the two in topological order are searched
+	bool CanReach(size_t src_idx, size_t dst_idx) const
+	{
+		const size_t from = comp[src_idx];
+		const size_t to = comp[dst_idx];
+		if (from == to)
+		{
+			return true;
+		}
+		if (from > to)
+		{
+			return false;
+		}
+
+		Bitset visited(NumComponents());
+		DSA<size_t> s(NumComponents());
+		size_t depth = 0;
+		visited.set(from);
+		s[depth++] = from;
+		while (depth > 0)
+		{
+			const size_t c = s[--depth];
+			for (size_t k = dag.EdgesBegin(c); k < dag.EdgesEnd(c); k++)
+			{
+				const size_t d = dag.Target(k);
+				if (d == to)
+				{
+					return true;
+				}
+				// anything past dst in topological order can't lead back to it
+				if (d < to && !visited.test_and_set(d))
+				{
+					s[depth++] = d;
+				}
+			}
+		}
+		return false;
+	}
+
+private:
+	// fills comp with the order in which tarjan's finishes each component
+	// and returns the num of components
+	size_t FindComponents(const CsrGraph& g)
+	{
+		const size_t n = g.NumVertices();
+		const size_t Unvisited = ~size_t(0);
+		// the order in which vertices were discovered
+		DSA<size_t> disc(n, Unvisited);
+		// smallest discovery num reachable through the vertex's subtree
+		// and at most one back edge
+		DSA<size_t> low(n);
+		// vertices whose component hasn't been finished yet
+		DSA<size_t> open(n);
+		Bitset on_open(n);
+		size_t open_size = 0;
+		// the dfs path and the next edge to follow from each vertex on it
+		DSA<size_t> path(n);
+		DSA<size_t> next(n);
+		size_t depth = 0;
+		size_t counter = 0;
+		size_t num_comps = 0;
+
+		for (size_t root = 0; root < n; root++)
+		{
+			if (disc[root] != Unvisited)
+			{
+				continue;
+			}
+			disc[root] = low[root] = counter++;
+			open[open_size++] = root;
+			on_open.set(root);
+			path[depth] = root;
+			next[depth] = g.EdgesBegin(root);
+			depth++;
+
+			while (depth > 0)
+			{
+				const size_t v = path[depth - 1];
+				size_t& k = next[depth - 1];
+				if (k < g.EdgesEnd(v))
+				{
+					const size_t w = g.Target(k++);
+					if (disc[w] == Unvisited)
+					{
+						disc[w] = low[w] = counter++;
+						open[open_size++] = w;
+						on_open.set(w);
+						path[depth] = w;
+						next[depth] = g.EdgesBegin(w);
+						depth++;
+					}
+					else if (on_open.test(w))
+					{
+						low[v] = std::min(low[v], disc[w]);
+					}
+					continue;
+				}
+
+				// every edge of v is done, return to its parent
+				depth--;
+				if (depth > 0)
+				{
+					const size_t parent = path[depth - 1];
+					low[parent] = std::min(low[parent], low[v]);
+				}
+				// v is the first vertex of its component to be discovered,
+				// everything above it on the open stack belongs with it
+				if (low[v] == disc[v])
+				{
+					size_t w;
+					do
+					{
+						w = open[--open_size];
+						on_open.reset(w);
+						comp[w] = num_comps;
+					} while (w != v);
+					num_comps++;
+				}
+			}
+		}
+		return num_comps;
+	}
+	// every vertex idx sorted by component
+	DSA<size_t> VerticesByComponent(size_t num_comps) const
+	{
+		const size_t n = comp.size();
+		DSA<size_t> start(num_comps + 1, 0);
+		for (size_t v = 0; v < n; v++)
+		{
+			start[comp[v] + 1]++;
+		}
+		for (size_t c = 0; c < num_comps; c++)
+		{
+			start[c + 1] += start[c];
+		}
+		DSA<size_t> order(n);
+		for (size_t v = 0; v < n; v++)
+		{
+			order[start[comp[v]]++] = v;
+		}
+		return order;
+	}
+
+private:
+	// comp[v] is the component of vertex v
+	DSA<size_t> comp;
+	CsrGraph dag;
+};
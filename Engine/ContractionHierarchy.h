@@ -0,0 +1,740 @@
+#pragma once
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+#include "Bitset.h"
+#include "CsrGraph.h"
+#include "IndexedHeap.h"
+#include "ShortestPath.h"
+
+// contraction hierarchy over a weighted directed graph
+// vertices are contracted one at a time in order of importance, and
+// whenever removing a vertex v would lengthen a shortest path u -> v -> x
+// a shortcut u -> x is added in its place
+// a shortest path then always exists that only climbs in rank from src and
+// only descends in rank to dst, so a query searches upward from both ends
+// and touches a tiny part of the graph
+// weights must not be negative
+class ContractionHierarchy
+{
+public:
+	// marks an edge that is not a shortcut
+	static constexpr size_t NoMid = ~size_t(0);
+
+	// one direction of the hierarchy in compressed sparse row form
+	struct Adjacency
+	{
+		DSA<size_t> offsets;
+		DSA<size_t> targets;
+		DSA<float> weights;
+		// the contracted vertex a shortcut bypasses, NoMid for original edges
+		DSA<size_t> mids;
+	};
+
+public:
+	// contracts every vertex of g and builds the upward/downward graphs
+	ContractionHierarchy(const CsrGraph& g)
+	{
+		Builder builder(g);
+		builder.ContractAll();
+		rank = std::move(builder.rank);
+		BuildAdjacency(builder);
+	}
+	// reads a hierarchy written by Save
+	// throws if the stream does not hold a valid hierarchy
+	static ContractionHierarchy Load(std::istream& in)
+	{
+		uint32_t magic = 0, version = 0;
+		in.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+		in.read(reinterpret_cast<char*>(&version), sizeof(version));
+		if (!in || magic != Magic || version != Version)
+		{
+			throw std::runtime_error("Not a contraction hierarchy");
+		}
+
+		ContractionHierarchy res;
+		ReadIndices(in, res.rank);
+		// every rank is used once, so rank is a valid contraction order
+		const size_t n = res.rank.size();
+		Bitset ranked(n);
+		for (size_t v = 0; v < n; v++)
+		{
+			if (res.rank[v] >= n || ranked.test_and_set(res.rank[v]))
+			{
+				throw std::runtime_error("Corrupt contraction hierarchy");
+			}
+		}
+		for (Adjacency* adj : { &res.up, &res.down })
+		{
+			ReadIndices(in, adj->offsets);
+			ReadIndices(in, adj->targets);
+			ReadIndices(in, adj->mids);
+			ReadFloats(in, adj->weights);
+			res.CheckArcs(*adj);
+		}
+		return res;
+	}
+	// writes the hierarchy in a binary form that Load can read back
+	void Save(std::ostream& out) const
+	{
+		const uint32_t magic = Magic, version = Version;
+		out.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+		out.write(reinterpret_cast<const char*>(&version), sizeof(version));
+		WriteIndices(out, rank);
+		for (const Adjacency* adj : { &up, &down })
+		{
+			WriteIndices(out, adj->offsets);
+			WriteIndices(out, adj->targets);
+			WriteIndices(out, adj->mids);
+			WriteFloats(out, adj->weights);
+		}
+	}
+
+	// num of vertices in the graph
+	size_t NumVertices() const
+	{
+		return rank.size();
+	}
+	// position of the vertex at idx in the contraction order
+	size_t Rank(size_t idx) const
+	{
+		return rank[idx];
+	}
+	// edges u -> x with rank[x] > rank[u], filed under u
+	const Adjacency& Up() const
+	{
+		return up;
+	}
+	// edges x -> u with rank[x] > rank[u], filed under u with target x
+	const Adjacency& Down() const
+	{
+		return down;
+	}
+
+	// replaces the edge from -> to that bypasses mid with the original edges it stands for
+	// appends every vertex after from up to and including to
+	void Unpack(size_t from, size_t to, size_t mid, DSA<size_t>& path) const
+	{
+		struct Pending
+		{
+			size_t from;
+			size_t to;
+			size_t mid;
+		};
+		// shortcuts nest, an explicit stack keeps deep ones off the call stack
+		DSA<Pending> stack;
+		stack.push_back(Pending{ from, to, mid });
+		while (stack.size() > 0)
+		{
+			const Pending e = stack.back();
+			stack.resize(stack.size() - 1);
+			if (e.mid == NoMid)
+			{
+				path.push_back(e.to);
+				continue;
+			}
+			// mid was contracted before both ends, so from -> mid is a
+			// downward edge filed under mid and mid -> to an upward one
+			stack.push_back(Pending{ e.mid, e.to, FindMid(up, e.mid, e.to) });
+			stack.push_back(Pending{ e.from, e.mid, FindMid(down, e.mid, e.from) });
+		}
+	}
+
+private:
+	ContractionHierarchy() = default;
+
+	// throws unless adj is a csr array of arcs that lead up the contraction
+	// order and bypass only vertices contracted before both their ends,
+	// which keeps the searches in bounds and makes Unpack terminate
+	void CheckArcs(const Adjacency& adj) const
+	{
+		const size_t n = rank.size();
+		if (adj.offsets.size() != n + 1 ||
+			adj.offsets[0] != 0 ||
+			adj.targets.size() != adj.offsets.back() ||
+			adj.mids.size() != adj.targets.size() ||
+			adj.weights.size() != adj.targets.size())
+		{
+			throw std::runtime_error("Corrupt contraction hierarchy");
+		}
+		for (size_t u = 0; u < n; u++)
+		{
+			if (adj.offsets[u] > adj.offsets[u + 1])
+			{
+				throw std::runtime_error("Corrupt contraction hierarchy");
+			}
+			for (size_t k = adj.offsets[u]; k < adj.offsets[u + 1]; k++)
+			{
+				const size_t x = adj.targets[k];
+				const size_t mid = adj.mids[k];
+				if (x >= n || rank[x] <= rank[u] ||
+					(mid != NoMid && (mid >= n || rank[mid] >= rank[u])))
+				{
+					throw std::runtime_error("Corrupt contraction hierarchy");
+				}
+			}
+		}
+	}
+
+	// returns the mid of the cheapest edge filed under owner with given target
+	static size_t FindMid(const Adjacency& adj, size_t owner, size_t target)
+	{
+		size_t best = NoMid;
+		float best_weight = std::numeric_limits<float>::infinity();
+		for (size_t k = adj.offsets[owner]; k < adj.offsets[owner + 1]; k++)
+		{
+			if (adj.targets[k] == target && adj.weights[k] < best_weight)
+			{
+				best = adj.mids[k];
+				best_weight = adj.weights[k];
+			}
+		}
+		assert(best_weight < std::numeric_limits<float>::infinity() && "Shortcut half is missing");
+		return best;
+	}
+
+	// an edge of the graph while it is being contracted
+	struct Arc
+	{
+		size_t to;
+		float weight;
+		size_t mid;
+	};
+
+	// holds the shrinking graph and runs the contraction
+	class Builder
+	{
+	public:
+		Builder(const CsrGraph& g)
+			:
+			n(g.NumVertices()),
+			out(n),
+			in(n),
+			contracted(n),
+			deleted_nbrs(n, 0),
+			rank(n, 0),
+			witness_dist(n, std::numeric_limits<float>::infinity()),
+			witness_target(n),
+			witness_heap(n)
+		{
+			for (size_t u = 0; u < n; u++)
+			{
+				for (size_t k = g.EdgesBegin(u); k < g.EdgesEnd(u); k++)
+				{
+					assert(g.Weight(k) >= 0.0f && "Negative edge weight");
+					if (g.Target(k) != u)
+					{
+						AddArc(u, g.Target(k), g.Weight(k), NoMid);
+					}
+				}
+			}
+		}
+
+		// contracts vertices in order of priority until none are left
+		void ContractAll()
+		{
+			IndexedHeap<> queue(n);
+			for (size_t v = 0; v < n; v++)
+			{
+				queue.push(v, Priority(v));
+			}
+
+			size_t next_rank = 0;
+			while (!queue.empty())
+			{
+				// priorities go stale as neighbours get contracted, so the
+				// top is only taken if it is still the smallest when refreshed
+				const size_t v = queue.top();
+				const float p = Priority(v);
+				queue.pop();
+				if (!queue.empty() && p > queue.top_key())
+				{
+					queue.push(v, p);
+					continue;
+				}
+
+				// the refresh above found exactly the shortcuts v needs
+				for (auto& sc : shortcuts)
+				{
+					AddArc(sc.from, sc.to, sc.weight, v);
+				}
+				contracted.set(v);
+				rank[v] = next_rank++;
+
+				// neighbours lost an edge, drop it from their lists (v keeps
+				// its own, those are the edges that end up in the hierarchy)
+				// and refresh their priority
+				for (auto& a : out[v])
+				{
+					if (!contracted.test(a.to))
+					{
+						RemoveArcsTo(in[a.to], v);
+						Touch(queue, a.to);
+					}
+				}
+				for (auto& a : in[v])
+				{
+					if (!contracted.test(a.to))
+					{
+						RemoveArcsTo(out[a.to], v);
+						Touch(queue, a.to);
+					}
+				}
+			}
+		}
+
+	private:
+		// counts v as a deleted neighbour of idx and refreshes its priority
+		void Touch(IndexedHeap<>& queue, size_t idx)
+		{
+			if (!contracted.test(idx) && queue.contains(idx))
+			{
+				deleted_nbrs[idx]++;
+				queue.update(idx, Priority(idx));
+			}
+		}
+		// lower is contracted earlier, favours vertices that add few
+		// shortcuts for the edges they remove and spreads contraction
+		// evenly by penalizing vertices whose neighbours are already gone
+		float Priority(size_t v)
+		{
+			size_t degree = 0;
+			for (auto& a : out[v])
+			{
+				degree += contracted.test(a.to) ? 0 : 1;
+			}
+			for (auto& a : in[v])
+			{
+				degree += contracted.test(a.to) ? 0 : 1;
+			}
+			FindShortcuts(v);
+			return float(shortcuts.size()) - float(degree) + float(deleted_nbrs[v]);
+		}
+		// fills shortcuts with the edges needed to remove v
+		void FindShortcuts(size_t v)
+		{
+			shortcuts.resize(0);
+			for (size_t i = 0; i < in[v].size(); i++)
+			{
+				const Arc into = in[v][i];
+				if (contracted.test(into.to))
+				{
+					continue;
+				}
+				const size_t u = into.to;
+
+				// the longest path through v that a witness would have to beat
+				float limit = 0.0f;
+				size_t num_targets = 0;
+				for (auto& a : out[v])
+				{
+					if (!contracted.test(a.to) && a.to != u)
+					{
+						limit = std::max(limit, into.weight + a.weight);
+						num_targets += witness_target.test_and_set(a.to) ? 0 : 1;
+					}
+				}
+				WitnessSearch(u, v, limit, num_targets);
+
+				for (auto& a : out[v])
+				{
+					witness_target.reset(a.to);
+					if (contracted.test(a.to) || a.to == u)
+					{
+						continue;
+					}
+					const float via = into.weight + a.weight;
+					if (witness_dist[a.to] > via)
+					{
+						shortcuts.push_back(Shortcut{ u, a.to, via });
+					}
+				}
+				ResetWitness();
+			}
+		}
+		// bounded dijkstra from src over uncontracted vertices other than skip
+		// stops once every target is settled, or once the limit or the settled
+		// vertex budget is reached, which only ever costs an unnecessary shortcut
+		void WitnessSearch(size_t src, size_t skip, float limit, size_t num_targets)
+		{
+			witness_dist[src] = 0.0f;
+			witness_touched.push_back(src);
+			witness_heap.push(src, 0.0f);
+
+			for (size_t settled = 0; !witness_heap.empty() && settled < WitnessBudget; settled++)
+			{
+				const size_t cur = witness_heap.top();
+				const float d = witness_heap.top_key();
+				witness_heap.pop();
+				if (d > limit)
+				{
+					break;
+				}
+				if (witness_target.test(cur) && --num_targets == 0)
+				{
+					break;
+				}
+				float* const dist = witness_dist.data();
+				for (auto& a : out[cur])
+				{
+					if (a.to == skip || contracted.test(a.to))
+					{
+						continue;
+					}
+					const float nd = d + a.weight;
+					if (nd < dist[a.to])
+					{
+						if (dist[a.to] == std::numeric_limits<float>::infinity())
+						{
+							witness_touched.push_back(a.to);
+						}
+						dist[a.to] = nd;
+						if (witness_heap.contains(a.to))
+							witness_heap.decrease(a.to, nd);
+						else
+							witness_heap.push(a.to, nd);
+					}
+				}
+			}
+		}
+		// undoes a witness search in time proportional to what it touched
+		void ResetWitness()
+		{
+			for (auto v : witness_touched)
+			{
+				witness_dist[v] = std::numeric_limits<float>::infinity();
+			}
+			witness_touched.resize(0);
+			witness_heap.clear();
+		}
+		// removes the edges to or from v in one of v's neighbour's lists
+		static void RemoveArcsTo(DSA<Arc>& list, size_t v)
+		{
+			size_t kept = 0;
+			for (size_t i = 0; i < list.size(); i++)
+			{
+				if (list[i].to != v)
+				{
+					list[kept++] = list[i];
+				}
+			}
+			list.resize(kept);
+		}
+		// adds u -> x or lowers the weight of the existing edge
+		void AddArc(size_t u, size_t x, float weight, size_t mid)
+		{
+			for (auto& a : out[u])
+			{
+				if (a.to == x)
+				{
+					if (weight < a.weight)
+					{
+						a.weight = weight;
+						a.mid = mid;
+						for (auto& b : in[x])
+						{
+							if (b.to == u)
+							{
+								b.weight = weight;
+								b.mid = mid;
+							}
+						}
+					}
+					return;
+				}
+			}
+			out[u].push_back(Arc{ x, weight, mid });
+			in[x].push_back(Arc{ u, weight, mid });
+		}
+
+	private:
+		// a shortcut from -> to that replaces the vertex being contracted
+		struct Shortcut
+		{
+			size_t from;
+			size_t to;
+			float weight;
+		};
+		static constexpr size_t WitnessBudget = 500;
+
+	public:
+		size_t n;
+		// out[u] holds u -> a.to, in[u] holds a.to -> u, including shortcuts
+		// and edges to vertices that have since been contracted
+		DSA<DSA<Arc>> out;
+		DSA<DSA<Arc>> in;
+		Bitset contracted;
+		DSA<size_t> deleted_nbrs;
+		DSA<size_t> rank;
+		DSA<float> witness_dist;
+		// out neighbours of the vertex being contracted
+		Bitset witness_target;
+		DSA<size_t> witness_touched;
+		IndexedHeap<> witness_heap;
+		// output of the last FindShortcuts call
+		DSA<Shortcut> shortcuts;
+	};
+
+	// keeps only the edges that climb in rank and packs them into csr form
+	void BuildAdjacency(const Builder& b)
+	{
+		const size_t n = b.n;
+		for (int dir = 0; dir < 2; dir++)
+		{
+			// up takes u's out edges, down takes u's in edges
+			const DSA<DSA<Arc>>& lists = dir == 0 ? b.out : b.in;
+			Adjacency& adj = dir == 0 ? up : down;
+
+			adj.offsets = DSA<size_t>(n + 1, 0);
+			for (size_t u = 0; u < n; u++)
+			{
+				size_t deg = 0;
+				for (auto& a : lists[u])
+				{
+					deg += rank[a.to] > rank[u] ? 1 : 0;
+				}
+				adj.offsets[u + 1] = adj.offsets[u] + deg;
+			}
+			adj.targets = DSA<size_t>(adj.offsets[n]);
+			adj.weights = DSA<float>(adj.offsets[n]);
+			adj.mids = DSA<size_t>(adj.offsets[n]);
+			size_t k = 0;
+			for (size_t u = 0; u < n; u++)
+			{
+				for (auto& a : lists[u])
+				{
+					if (rank[a.to] > rank[u])
+					{
+						adj.targets[k] = a.to;
+						adj.weights[k] = a.weight;
+						adj.mids[k] = a.mid;
+						k++;
+					}
+				}
+			}
+		}
+	}
+
+	// size_t arrays are always written as 64 bit values so files can be
+	// shared between 32 and 64 bit builds
+	static void WriteIndices(std::ostream& out, const DSA<size_t>& arr)
+	{
+		const uint64_t count = arr.size();
+		out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+		for (auto v : arr)
+		{
+			const uint64_t val = v == NoMid ? ~uint64_t(0) : uint64_t(v);
+			out.write(reinterpret_cast<const char*>(&val), sizeof(val));
+		}
+	}
+	static void ReadIndices(std::istream& in, DSA<size_t>& arr)
+	{
+		uint64_t count = 0;
+		in.read(reinterpret_cast<char*>(&count), sizeof(count));
+		if (!in)
+		{
+			throw std::runtime_error("Truncated contraction hierarchy");
+		}
+		// grown as values arrive so a corrupt count fails on the end of
+		// the stream instead of allocating it all up front
+		arr = DSA<size_t>(0);
+		for (uint64_t i = 0; i < count; i++)
+		{
+			uint64_t val = 0;
+			in.read(reinterpret_cast<char*>(&val), sizeof(val));
+			if (!in)
+			{
+				throw std::runtime_error("Truncated contraction hierarchy");
+			}
+			arr.push_back(val == ~uint64_t(0) ? NoMid : size_t(val));
+		}
+	}
+	static void WriteFloats(std::ostream& out, const DSA<float>& arr)
+	{
+		const uint64_t count = arr.size();
+		out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+		out.write(reinterpret_cast<const char*>(arr.data()), arr.size() * sizeof(float));
+	}
+	static void ReadFloats(std::istream& in, DSA<float>& arr)
+	{
+		uint64_t count = 0;
+		in.read(reinterpret_cast<char*>(&count), sizeof(count));
+		arr = DSA<float>(0);
+		for (uint64_t i = 0; i < count; i++)
+		{
+			float val = 0.0f;
+			in.read(reinterpret_cast<char*>(&val), sizeof(val));
+			if (!in)
+			{
+				throw std::runtime_error("Truncated contraction hierarchy");
+			}
+			arr.push_back(val);
+		}
+	}
+
+private:
+	static constexpr uint32_t Magic = 0x45494843; // "CHIE"
+	static constexpr uint32_t Version = 1;
+
+private:
+	// position of every vertex in the contraction order
+	DSA<size_t> rank;
+	Adjacency up;
+	Adjacency down;
+};
+
+// answers shortest path queries on a contraction hierarchy
+// keeps its work arrays between queries and only resets what a query
+// touched, so each query costs time proportional to the search space
+// not the graph, one object per thread
+class ChQuery
+{
+public:
+	// prepares queries on ch, which must outlive this object
+	ChQuery(const ContractionHierarchy& ch)
+		:
+		ch(ch),
+		fwd(ch.NumVertices()),
+		bwd(ch.NumVertices())
+	{}
+
+	// finds the shortest path from the src idx to the dst idx
+	WeightedPath ShortestPath(size_t src_idx, size_t dst_idx)
+	{
+		const size_t n = ch.NumVertices();
+		assert(src_idx < n && "Vertex does not exist");
+		assert(dst_idx < n && "Vertex does not exist");
+
+		WeightedPath res;
+		if (src_idx == dst_idx)
+		{
+			res.path = DSA<size_t>(1, src_idx);
+			res.distance = 0.0f;
+			return res;
+		}
+
+		fwd.Start(src_idx);
+		bwd.Start(dst_idx);
+		float best = std::numeric_limits<float>::infinity();
+		size_t meet = n;
+
+		// alternate between the searches, always advancing the one with
+		// the closer frontier, until neither can improve on best
+		while (!fwd.heap.empty() || !bwd.heap.empty())
+		{
+			const float f_top = fwd.heap.empty() ? best : fwd.heap.top_key();
+			const float b_top = bwd.heap.empty() ? best : bwd.heap.top_key();
+			if (std::min(f_top, b_top) >= best)
+			{
+				break;
+			}
+			Side& side = f_top <= b_top ? fwd : bwd;
+			const Side& other = f_top <= b_top ? bwd : fwd;
+			const ContractionHierarchy::Adjacency& adj = f_top <= b_top ? ch.Up() : ch.Down();
+
+			const size_t cur = side.heap.top();
+			const float d = side.heap.top_key();
+			side.heap.pop();
+			if (d + other.dist[cur] < best)
+			{
+				best = d + other.dist[cur];
+				meet = cur;
+			}
+			side.Relax(adj, cur, d);
+		}
+
+		if (meet != n)
+		{
+			// src .. meet from the upward search, then meet .. dst
+			// from the downward one, with every shortcut unpacked
+			DSA<size_t> chain;
+			for (size_t v = meet; v != src_idx; v = fwd.pred[v])
+			{
+				chain.push_back(v);
+			}
+			res.path.push_back(src_idx);
+			size_t prev = src_idx;
+			for (size_t i = chain.size(); i > 0; i--)
+			{
+				const size_t v = chain[i - 1];
+				ch.Unpack(prev, v, ch.Up().mids[fwd.pred_edge[v]], res.path);
+				prev = v;
+			}
+			for (size_t v = meet; v != dst_idx; v = bwd.pred[v])
+			{
+				ch.Unpack(v, bwd.pred[v], ch.Down().mids[bwd.pred_edge[v]], res.path);
+			}
+			res.distance = best;
+		}
+
+		fwd.Reset();
+		bwd.Reset();
+		return res;
+	}
+
+private:
+	// state of one of the two upward searches
+	struct Side
+	{
+		Side(size_t n)
+			:
+			dist(n, std::numeric_limits<float>::infinity()),
+			pred(n),
+			pred_edge(n),
+			heap(n)
+		{}
+		void Start(size_t src_idx)
+		{
+			dist[src_idx] = 0.0f;
+			pred[src_idx] = src_idx;
+			touched.push_back(src_idx);
+			heap.push(src_idx, 0.0f);
+		}
+		void Relax(const ContractionHierarchy::Adjacency& adj, size_t cur, float d)
+		{
+			for (size_t k = adj.offsets[cur]; k < adj.offsets[cur + 1]; k++)
+			{
+				const size_t nbr = adj.targets[k];
+				const float nd = d + adj.weights[k];
+				if (nd < dist[nbr])
+				{
+					if (dist[nbr] == std::numeric_limits<float>::infinity())
+					{
+						touched.push_back(nbr);
+					}
+					dist[nbr] = nd;
+					pred[nbr] = cur;
+					pred_edge[nbr] = k;
+					if (heap.contains(nbr))
+						heap.decrease(nbr, nd);
+					else
+						heap.push(nbr, nd);
+				}
+			}
+		}
+		void Reset()
+		{
+			for (auto v : touched)
+			{
+				dist[v] = std::numeric_limits<float>::infinity();
+			}
+			touched.resize(0);
+			heap.clear();
+		}
+
+		DSA<float> dist;
+		DSA<size_t> pred;
+		// position of the edge each vertex was reached by
+		DSA<size_t> pred_edge;
+		DSA<size_t> touched;
+		IndexedHeap<> heap;
+	};
+
+private:
+	const ContractionHierarchy& ch;
+	Side fwd;
+	Side bwd;
+};
@@ -0,0 +1,627 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include "DSA.h"
+#include "Bitset.h"
+#include "Graph.h"
+#include "IndexedHeap.h"
+#include "ShortestPath.h"
+
+// immutable graph stored in compressed sparse row form
+// the edges leaving vertex v are stored contiguously at positions
+// offsets[v] .. offsets[v + 1] - 1 of the targets and weights arrays
+// the arrays are either owned or a view into memory kept alive by
+// someone else, like a mapped graph file
+class CsrGraph
+{
+public:
+	// a single edge of an edge list
+	struct Edge
+	{
+		size_t src_idx;
+		size_t dst_idx;
+		float weight;
+	};
+
+public:
+	// ctor
+	CsrGraph()
+		:
+		offsets(1, 0),
+		targets(0),
+		weights(0)
+	{
+		Bind();
+	}
+	// freezes an adjacency list graph, vertex indices are preserved
+	template <typename V>
+	explicit CsrGraph(const Graph<V>& g)
+		:
+		offsets(g.GetVertices().size() + 1, 0)
+	{
+		const size_t n = g.GetVertices().size();
+		for (size_t i = 0; i < n; i++)
+		{
+			size_t deg = 0;
+			for (auto& e : g.GetAdjList_idx(i))
+			{
+				deg++;
+			}
+			offsets[i + 1] = offsets[i] + deg;
+		}
+
+		targets = DSA<size_t>(offsets[n]);
+		weights = DSA<float>(offsets[n]);
+		size_t k = 0;
+		for (size_t i = 0; i < n; i++)
+		{
+			for (auto& e : g.GetAdjList_idx(i))
+			{
+				targets[k] = e.dst_idx;
+				weights[k] = e.weight;
+				k++;
+			}
+		}
+		Bind();
+	}
+	// builds a graph with num_verts vertices from an unordered edge list
+	// edges leaving the same vertex keep their relative order
+	CsrGraph(size_t num_verts, const DSA<Edge>& edge_list)
+		:
+		offsets(num_verts + 1, 0),
+		targets(edge_list.size()),
+		weights(edge_list.size())
+	{
+		// count the out degree of every vertex
+		for (auto& e : edge_list)
+		{
+			assert(e.src_idx < num_verts && "Vertex does not exist");
+			assert(e.dst_idx < num_verts && "Vertex does not exist");
+			offsets[e.src_idx + 1]++;
+		}
+		for (size_t i = 0; i < num_verts; i++)
+		{
+			offsets[i + 1] += offsets[i];
+		}
+
+		// scatter every edge into the next free slot of its source
+		DSA<size_t> cursor(num_verts);
+		for (size_t i = 0; i < num_verts; i++)
+		{
+			cursor[i] = offsets[i];
+		}
+		for (auto& e : edge_list)
+		{
+			const size_t k = cursor[e.src_idx]++;
+			targets[k] = e.dst_idx;
+			weights[k] = e.weight;
+		}
+		Bind();
+	}
+	// takes over arrays already in csr form, offsets must hold one entry
+	// more than there are vertices and end with the num of targets
+	CsrGraph(DSA<size_t> offsets, DSA<size_t> targets, DSA<float> weights)
+		:
+		offsets(std::move(offsets)),
+		targets(std::move(targets)),
+		weights(std::move(weights))
+	{
+		assert(this->offsets.size() > 0 && this->offsets[this->offsets.size() - 1] == this->targets.size() &&
+			this->targets.size() == this->weights.size() && "Arrays are not in csr form");
+		Bind();
+	}
+	CsrGraph(const CsrGraph& rhs)
+	{
+		*this = rhs;
+	}
+	// moves the arrays straight in, default constructed ones would allocate
+	CsrGraph(CsrGraph&& rhs) noexcept
+		:
+		offsets(std::move(rhs.offsets)),
+		targets(std::move(rhs.targets)),
+		weights(std::move(rhs.weights))
+	{
+		Adopt(rhs);
+		rhs.Release();
+	}
+	CsrGraph& operator=(const CsrGraph& rhs)
+	{
+		if (this != &rhs)
+		{
+			offsets = rhs.offsets;
+			targets = rhs.targets;
+			weights = rhs.weights;
+			Adopt(rhs);
+		}
+		return *this;
+	}
+	CsrGraph& operator=(CsrGraph&& rhs) noexcept
+	{
+		if (this != &rhs)
+		{
+			offsets = std::move(rhs.offsets);
+			targets = std::move(rhs.targets);
+			weights = std::move(rhs.weights);
+			Adopt(rhs);
+			rhs.Release();
+		}
+		return *this;
+	}
+	// a graph over arrays it doesn't own, offsets must hold num_verts + 1
+	// entries and targets and weights offsets[num_verts] each
+	// backing is held on to for as long as the graph or a copy of it lives
+	static CsrGraph View(size_t num_verts, const size_t* offsets, const size_t* targets,
+		const float* weights, std::shared_ptr<const void> backing)
+	{
+		CsrGraph res;
+		res.offsets_ptr = offsets;
+		res.targets_ptr = targets;
+		res.weights_ptr = weights;
+		res.num_verts = num_verts;
+		res.num_edges = offsets[num_verts];
+		res.backing = std::move(backing);
+		return res;
+	}
+
+	// num of vertices in the graph
+	size_t NumVertices() const
+	{
+		return num_verts;
+	}
+	// num of edges in the graph
+	size_t NumEdges() const
+	{
+		return num_edges;
+	}
+	// num of edges leaving vertex at given idx
+	size_t Degree(size_t idx) const
+	{
+		return offsets_ptr[idx + 1] - offsets_ptr[idx];
+	}
+	// position of the first edge leaving vertex at given idx
+	size_t EdgesBegin(size_t idx) const
+	{
+		return offsets_ptr[idx];
+	}
+	// position one past the last edge leaving vertex at given idx
+	size_t EdgesEnd(size_t idx) const
+	{
+		return offsets_ptr[idx + 1];
+	}
+	// dst vertex of the edge at given position
+	size_t Target(size_t edge) const
+	{
+		return targets_ptr[edge];
+	}
+	// weight of the edge at given position
+	float Weight(size_t edge) const
+	{
+		return weights_ptr[edge];
+	}
+
+	// returns a graph with every edge reversed
+	// the edges leaving v in the result are the edges entering v in this graph
+	CsrGraph Transpose() const
+	{
+		const size_t n = NumVertices();
+		CsrGraph res;
+		res.offsets = DSA<size_t>(n + 1, 0);
+		res.targets = DSA<size_t>(NumEdges());
+		res.weights = DSA<float>(NumEdges());
+
+		for (size_t k = 0; k < NumEdges(); k++)
+		{
+			res.offsets[targets_ptr[k] + 1]++;
+		}
+		for (size_t i = 0; i < n; i++)
+		{
+			res.offsets[i + 1] += res.offsets[i];
+		}
+		DSA<size_t> cursor(n);
+		for (size_t i = 0; i < n; i++)
+		{
+			cursor[i] = res.offsets[i];
+		}
+		for (size_t src = 0; src < n; src++)
+		{
+			for (size_t k = offsets_ptr[src]; k < offsets_ptr[src + 1]; k++)
+			{
+				const size_t pos = cursor[targets_ptr[k]]++;
+				res.targets[pos] = src;
+				res.weights[pos] = weights_ptr[k];
+			}
+		}
+		res.Bind();
+		return res;
+	}
+
+	// performs bredth first search starting at the source idx
+	// until the dst idx is found, returns the shortest path (in edges)
+	// from src to dst or an empty array if dst is unreachable
+	DSA<size_t> BFS_idx(size_t src_idx, size_t dst_idx) const
+	{
+		const size_t n = NumVertices();
+		assert(src_idx < n && "Vertex does not exist");
+		assert(dst_idx < n && "Vertex does not exist");
+
+		const size_t* const offs = offsets_ptr;
+		const size_t* const tgts = targets_ptr;
+
+		Bitset visited(n);
+		DSA<size_t> pred(n);
+		DSA<size_t> q(n);
+		size_t head = 0, tail = 0;
+
+		visited.set(src_idx);
+		pred[src_idx] = src_idx;
+		q[tail++] = src_idx;
+
+		while (head < tail)
+		{
+			const size_t cur = q[head++];
+			if (cur == dst_idx)
+			{
+				return BuildPath(pred, src_idx, dst_idx);
+			}
+
+			// adjacent vertices are contiguous so this is a linear scan
+			for (size_t k = offs[cur]; k < offs[cur + 1]; k++)
+			{
+				const size_t nbr = tgts[k];
+				if (!visited.test_and_set(nbr))
+				{
+					pred[nbr] = cur;
+					q[tail++] = nbr;
+				}
+			}
+		}
+
+		return DSA<size_t>();
+	}
+	// performs depth first search starting at the source idx
+	// until the dst idx is found, returns the path from src to dst
+	// or an empty array if dst is unreachable
+	DSA<size_t> DFS_idx(size_t src_idx, size_t dst_idx) const
+	{
+		const size_t n = NumVertices();
+		assert(src_idx < n && "Vertex does not exist");
+		assert(dst_idx < n && "Vertex does not exist");
+
+		if (src_idx == dst_idx)
+		{
+			return DSA<size_t>(1, src_idx);
+		}
+
+		const size_t* const offs = offsets_ptr;
+		const size_t* const tgts = targets_ptr;
+
+		Bitset visited(n);
+		// the current path and the next edge to explore from each vertex on it
+		DSA<size_t> path_verts(n);
+		DSA<size_t> path_next(n);
+		size_t depth = 0;
+
+		visited.set(src_idx);
+		path_verts[depth] = src_idx;
+		path_next[depth] = offs[src_idx];
+		depth++;
+
+		while (depth > 0)
+		{
+			const size_t top = path_verts[depth - 1];
+			size_t& next = path_next[depth - 1];
+			// all neighbours explored, backtrack
+			if (next == offs[top + 1])
+			{
+				depth--;
+				continue;
+			}
+
+			const size_t nbr = tgts[next++];
+			if (visited.test_and_set(nbr))
+			{
+				continue;
+			}
+
+			if (nbr == dst_idx)
+			{
+				DSA<size_t> path(depth + 1);
+				for (size_t i = 0; i < depth; i++)
+				{
+					path[i] = path_verts[i];
+				}
+				path[depth] = dst_idx;
+				return path;
+			}
+			path_verts[depth] = nbr;
+			path_next[depth] = offs[nbr];
+			depth++;
+		}
+
+		return DSA<size_t>();
+	}
+	// computes the hop count from the source idx to every vertex
+	// unreachable vertices are given a distance of NumVertices()
+	DSA<size_t> BFS_dist(size_t src_idx) const
+	{
+		const size_t n = NumVertices();
+		assert(src_idx < n && "Vertex does not exist");
+
+		const size_t* const offs = offsets_ptr;
+		const size_t* const tgts = targets_ptr;
+
+		DSA<size_t> dist(n, n);
+		DSA<size_t> q(n);
+		size_t head = 0, tail = 0;
+
+		dist[src_idx] = 0;
+		q[tail++] = src_idx;
+
+		while (head < tail)
+		{
+			const size_t cur = q[head++];
+			const size_t d = dist[cur] + 1;
+			for (size_t k = offs[cur]; k < offs[cur + 1]; k++)
+			{
+				const size_t nbr = tgts[k];
+				if (dist[nbr] == n)
+				{
+					dist[nbr] = d;
+					q[tail++] = nbr;
+				}
+			}
+		}
+
+		return dist;
+	}
+
+	// finds the shortest path from the source idx to the dst idx
+	// where the length of a path is the sum of its edge weights
+	// weights must not be negative
+	WeightedPath Dijkstra_idx(size_t src_idx, size_t dst_idx) const
+	{
+		assert(dst_idx < NumVertices() && "Vertex does not exist");
+		return RunDijkstra(src_idx, dst_idx).PathTo(dst_idx);
+	}
+	// finds the shortest path from the source idx to the dst idx with A* search
+	// the heuristic is called as h(idx, dst_idx) and must never overestimate
+	// the remaining distance for the returned path to be the shortest
+	template <typename Heuristic>
+	WeightedPath AStar_idx(size_t src_idx, size_t dst_idx, const Heuristic& h) const
+	{
+		const size_t n = NumVertices();
+		assert(src_idx < n && "Vertex does not exist");
+		assert(dst_idx < n && "Vertex does not exist");
+
+		const size_t* const offs = offsets_ptr;
+		const size_t* const tgts = targets_ptr;
+		const float* const wts = weights_ptr;
+
+		ShortestPathTree tree(src_idx, n);
+		float* const dist = tree.dist.data();
+		IndexedHeap<> open(n);
+
+		dist[src_idx] = 0.0f;
+		tree.pred[src_idx] = src_idx;
+		open.push(src_idx, h(src_idx, dst_idx));
+
+		while (!open.empty())
+		{
+			const size_t cur = open.top();
+			open.pop();
+			if (cur == dst_idx)
+			{
+				return tree.PathTo(dst_idx);
+			}
+
+			const float d = dist[cur];
+			for (size_t k = offs[cur]; k < offs[cur + 1]; k++)
+			{
+				assert(wts[k] >= 0.0f && "Negative edge weight");
+				const size_t nbr = tgts[k];
+				const float nd = d + wts[k];
+				if (nd < dist[nbr])
+				{
+					dist[nbr] = nd;
+					tree.pred[nbr] = cur;
+					const float f = nd + h(nbr, dst_idx);
+					if (open.contains(nbr))
+						open.decrease(nbr, f);
+					else
+						open.push(nbr, f);
+				}
+			}
+		}
+
+		return WeightedPath();
+	}
+	// finds the shortest paths from the source idx to every vertex
+	// weights must not be negative
+	ShortestPathTree DijkstraAll_idx(size_t src_idx) const
+	{
+		return RunDijkstra(src_idx, NumVertices());
+	}
+
+private:
+	// dijkstra's algorithm from src, stops early once stop_idx is settled
+	ShortestPathTree RunDijkstra(size_t src_idx, size_t stop_idx) const
+	{
+		const size_t n = NumVertices();
+		assert(src_idx < n && "Vertex does not exist");
+
+		const size_t* const offs = offsets_ptr;
+		const size_t* const tgts = targets_ptr;
+		const float* const wts = weights_ptr;
+
+		ShortestPathTree tree(src_idx, n);
+		float* const dist = tree.dist.data();
+		IndexedHeap<> heap(n);
+
+		dist[src_idx] = 0.0f;
+		tree.pred[src_idx] = src_idx;
+		heap.push(src_idx, 0.0f);
+
+		while (!heap.empty())
+		{
+			const size_t cur = heap.top();
+			const float d = heap.top_key();
+			heap.pop();
+			if (cur == stop_idx)
+			{
+				break;
+			}
+
+			for (size_t k = offs[cur]; k < offs[cur + 1]; k++)
+			{
+				assert(wts[k] >= 0.0f && "Negative edge weight");
+				const size_t nbr = tgts[k];
+				const float nd = d + wts[k];
+				if (nd < dist[nbr])
+				{
+					dist[nbr] = nd;
+					tree.pred[nbr] = cur;
+					if (heap.contains(nbr))
+						heap.decrease(nbr, nd);
+					else
+						heap.push(nbr, nd);
+				}
+			}
+		}
+
+		return tree;
+	}
+
+private:
+	// points the accessors at the owned arrays
+	void Bind()
+	{
+		offsets_ptr = offsets.data();
+		targets_ptr = targets.data();
+		weights_ptr = weights.data();
+		// the arrays of a graph that has been moved from are empty
+		num_verts = offsets.size() > 0 ? offsets.size() - 1 : 0;
+		num_edges = targets.size();
+		backing.reset();
+	}
+	// points the accessors at the same arrays as rhs, or at the owned
+	// arrays if rhs owns its own (which have just been copied or moved here)
+	void Adopt(const CsrGraph& rhs)
+	{
+		if (rhs.backing)
+		{
+			offsets_ptr = rhs.offsets_ptr;
+			targets_ptr = rhs.targets_ptr;
+			weights_ptr = rhs.weights_ptr;
+			num_verts = rhs.num_verts;
+			num_edges = rhs.num_edges;
+			backing = rhs.backing;
+		}
+		else
+		{
+			Bind();
+		}
+	}
+	// leaves a graph whose arrays have been moved out as an empty graph
+	void Release() noexcept
+	{
+		offsets_ptr = nullptr;
+		targets_ptr = nullptr;
+		weights_ptr = nullptr;
+		num_verts = 0;
+		num_edges = 0;
+		backing.reset();
+	}
+
+private:
+	// offsets[v] is the position of the first edge leaving v
+	// offsets[NumVertices()] is the total num of edges
+	DSA<size_t> offsets;
+	// dst vertex of every edge, grouped by src vertex
+	DSA<size_t> targets;
+	// weight of every edge, parallel to targets
+	DSA<float> weights;
+	// the arrays every accessor reads, either the ones above or a view
+	const size_t* offsets_ptr = nullptr;
+	const size_t* targets_ptr = nullptr;
+	const float* weights_ptr = nullptr;
+	size_t num_verts = 0;
+	size_t num_edges = 0;
+	// keeps the memory of a view alive, null if the arrays are owned
+	std::shared_ptr<const void> backing;
+};
+
+// csr copy of an adjacency list graph that is only rebuilt when it is asked
+// for after the graph has changed, so a stream of updates costs nothing
+// until a query actually needs the frozen form
+template <typename V>
+class CsrSnapshot
+{
+public:
+	explicit CsrSnapshot(const Graph<V>& g)
+		:
+		g(g)
+	{}
+
+	// the csr form of the graph as it is now
+	const CsrGraph& Get()
+	{
+		if (IsStale())
+		{
+			csr = CsrGraph(g);
+			version = g.Version();
+		}
+		return csr;
+	}
+	// true if the graph has changed since the last rebuild
+	bool IsStale() const
+	{
+		return version != g.Version();
+	}
+	// version of the graph the csr form was last built from
+	size_t Version() const
+	{
+		return version;
+	}
+
+private:
+	const Graph<V>& g;
+	CsrGraph csr;
+	// version of the graph csr was built from, none at first
+	size_t version = ~size_t(0);
+};
+
+// a structure derived from the csr form of a graph, like a ReachabilityIndex,
+// LandmarkIndex or AllPairsShortestPaths, that is invalidated by any update
+// to the graph and only rebuilt when it is next asked for
+// several of them can share one snapshot so the csr form is built once
+template <typename V, typename T>
+class LazyIndex
+{
+public:
+	// build makes a T from the csr form, snapshot must outlive this object
+	LazyIndex(CsrSnapshot<V>& snapshot, std::function<T(const CsrGraph&)> build)
+		:
+		snapshot(snapshot),
+		build(std::move(build))
+	{}
+
+	// the structure for the graph as it is now
+	const T& Get()
+	{
+		const CsrGraph& csr = snapshot.Get();
+		if (!value || version != snapshot.Version())
+		{
+			value.reset(new T(build(csr)));
+			version = snapshot.Version();
+		}
+		return *value;
+	}
+
+private:
+	CsrSnapshot<V>& snapshot;
+	std::function<T(const CsrGraph&)> build;
+	std::unique_ptr<T> value;
+	// version of the graph value was built from
+	size_t version = ~size_t(0);
+};
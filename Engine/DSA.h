@@ -118,11 +118,35 @@ public:
 	{
 		*this = rhs;
 	}
+	DSA(DSA&& rhs) noexcept
+		:
+		max_size(rhs.max_size),
+		cur_size(rhs.cur_size),
+		arr(rhs.arr)
+	{
+		rhs.max_size = 0;
+		rhs.cur_size = 0;
+		rhs.arr = nullptr;
+	}
+	DSA& operator=(DSA&& rhs) noexcept
+	{
+		if (this == &rhs)
+			return *this;
+		delete[] arr;
+
+		max_size = rhs.max_size;
+		cur_size = rhs.cur_size;
+		arr = rhs.arr;
+		rhs.max_size = 0;
+		rhs.cur_size = 0;
+		rhs.arr = nullptr;
+		return *this;
+	}
 	DSA& operator=(const DSA& rhs)
 	{
 		if (this == &rhs)
 			return *this;
-		delete arr;
+		delete[] arr;
 
 		max_size = rhs.max_size;
 		cur_size = rhs.cur_size;
@@ -135,7 +159,8 @@ public:
 	{
 		if (cur_size == max_size)
 		{
-			resize(cur_size * 2);
+			// an array created empty has no capacity to double
+			resize(cur_size > 0 ? cur_size * 2 : 1);
 		}
 		arr[cur_size++] = val;
 	}
@@ -180,6 +205,16 @@ public:
 		return max_size;
 	}
 
+	// pointer to the underlying array
+	T* data()
+	{
+		return arr;
+	}
+	const T* data() const
+	{
+		return arr;
+	}
+
 	const T& front() const
 	{
 		assert(cur_size > 0);
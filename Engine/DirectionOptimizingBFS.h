@@ -0,0 +1,135 @@
+#pragma once
+#include "CsrGraph.h"
+#include "Bitset.h"
+#include "ShortestPath.h"
+
+// whole graph bredth first search that switches between expanding the
+// frontier top-down (frontier vertices look at their out edges) and
+// bottom-up (unvisited vertices look for a parent in the frontier)
+// bottom-up steps win on large frontiers of low diameter graphs since an
+// unvisited vertex can stop at the first parent it finds
+class DirectionOptimizingBFS
+{
+public:
+	// prepares a search over g, which must outlive this object
+	// symmetric graphs (every edge has a reverse edge) can skip building
+	// the transposed graph used by bottom-up steps
+	DirectionOptimizingBFS(const CsrGraph& g, bool symmetric = false)
+		:
+		g(g),
+		rev(symmetric ? CsrGraph() : g.Transpose()),
+		in(symmetric ? g : rev)
+	{}
+	// in may refer to rev, which a copy or move would leave behind
+	DirectionOptimizingBFS(const DirectionOptimizingBFS&) = delete;
+	DirectionOptimizingBFS& operator=(const DirectionOptimizingBFS&) = delete;
+
+	// computes the hop count to and parent of every vertex reachable from src
+	BfsTree Run(size_t src_idx) const
+	{
+		const size_t n = g.NumVertices();
+		assert(src_idx < n && "Vertex does not exist");
+
+		BfsTree tree(src_idx, n);
+		size_t* const dist = tree.dist.data();
+		size_t* const parent = tree.parent.data();
+
+		// every vertex is appended once, so the levels are consecutive
+		// ranges of this array whichever direction discovered them
+		DSA<size_t> q(n);
+		size_t* const queue = q.data();
+		size_t head = 0, tail = 0;
+		// dense copy of the current level for bottom-up steps
+		Bitset frontier(n);
+
+		dist[src_idx] = 0;
+		parent[src_idx] = src_idx;
+		queue[tail++] = src_idx;
+
+		// edges leaving the frontier and edges leaving unvisited vertices
+		size_t frontier_edges = g.Degree(src_idx);
+		size_t unvisited_edges = g.NumEdges() - frontier_edges;
+		bool bottom_up = false;
+
+		for (size_t level = 1; head < tail; level++)
+		{
+			const size_t level_end = tail;
+			const size_t frontier_size = level_end - head;
+			// switch to bottom-up once the frontier touches a good part of the
+			// remaining edges, back to top-down once it has shrunk again
+			if (!bottom_up)
+			{
+				bottom_up = frontier_edges > unvisited_edges / Alpha;
+			}
+			else
+			{
+				bottom_up = frontier_size >= n / Beta;
+			}
+
+			size_t next_edges = 0;
+			if (!bottom_up)
+			{
+				for (; head < level_end; head++)
+				{
+					const size_t cur = queue[head];
+					for (size_t k = g.EdgesBegin(cur); k < g.EdgesEnd(cur); k++)
+					{
+						const size_t nbr = g.Target(k);
+						if (dist[nbr] == n)
+						{
+							dist[nbr] = level;
+							parent[nbr] = cur;
+							queue[tail++] = nbr;
+							next_edges += g.Degree(nbr);
+						}
+					}
+				}
+			}
+			else
+			{
+				frontier.clear();
+				for (; head < level_end; head++)
+				{
+					frontier.set(queue[head]);
+				}
+				for (size_t v = 0; v < n; v++)
+				{
+					if (dist[v] != n)
+					{
+						continue;
+					}
+					for (size_t k = in.EdgesBegin(v); k < in.EdgesEnd(v); k++)
+					{
+						const size_t p = in.Target(k);
+						if (frontier.test(p))
+						{
+							dist[v] = level;
+							parent[v] = p;
+							queue[tail++] = v;
+							next_edges += g.Degree(v);
+							break;
+						}
+					}
+				}
+			}
+
+			unvisited_edges -= next_edges;
+			frontier_edges = next_edges;
+		}
+
+		return tree;
+	}
+
+private:
+	// go bottom-up when frontier edges exceed unvisited edges / Alpha
+	static constexpr size_t Alpha = 14;
+	// go back top-down when the frontier holds fewer than n / Beta vertices
+	static constexpr size_t Beta = 24;
+
+private:
+	const CsrGraph& g;
+	// transpose of g, empty if g is symmetric
+	CsrGraph rev;
+	// the graph whose out edges are the in edges of g
+	const CsrGraph& in;
+};
@@ -41,28 +41,28 @@ Game::Game( MainWindow& wnd )
 		g.AddVertex(Node(i + 1, pos));
 	}
 
-	// read edges from file
-	for (size_t i = 0, k = 0; i < doc.GetRowCount() && k < NumVertices; i++)
+	// read edges from the mapped file
+	const MappedGraph<uint64_t> file = LoadGraph();
+	const CsrGraph& fileGraph = file.GetGraph();
+	const size_t numSources = std::min(size_t(NumVertices), fileGraph.NumVertices());
+	GraphBuilder builder(NumVertices);
+	for (size_t src = 0; src < numSources; src++)
 	{
-		// the source vertex
-		const size_t src = doc.GetCell<size_t>(SrcColIdx, i);
-		// the number of edges from this source
-		const size_t numNeighbours = doc.GetCell<size_t>(NeighbourCountColIdx, i);
-		
-		// check if this vertex already has edges
-		// this is needed as there are duplicates in the file
-		if (g.GetAdjList_idx(src - 1).empty())
+		// keep every edge to a neighbour that is on screen
+		for (size_t k = fileGraph.EdgesBegin(src); k < fileGraph.EdgesEnd(src); k++)
 		{
-			k++;
-			// read a destination vertex and add an edge to it from source
-			for (size_t j = 0; j < numNeighbours; j++)
+			if (fileGraph.Target(k) < NumVertices)
 			{
-				// the destination vertex
-				const size_t neighbour_j = doc.GetCell<size_t>(firstNeighbourColIdx + 3 * j, i);
-				g.AddEdge_idx(src - 1, neighbour_j - 1);
+				builder.AddEdge(src, fileGraph.Target(k));
 			}
 		}
 	}
+	// add them all at once with any parallel edges dropped
+	ThreadPool pool;
+	builder.MergeParallelEdges(ParallelEdges::First).BuildInto(g, pool);
+
+	// the graph never changes after loading so every BFS path is computed up front
+	hops = AllPairsShortestPaths::FromBFS(CsrGraph(g), pool);
 
 	// enabling auto repeat allows us to press and hold a key
 	// and have it read as multiple presses
@@ -98,7 +98,15 @@ void Game::UpdateModel()
 
 			// use the pathfinding algo currently selected
 			if (useBFS)
-				path = g.BFS(Node(src), Node(dst));
+			{
+				// read the precomputed path off the next hop matrix
+				const auto& indices = hops.Path_idx(src - 1, dst - 1);
+				path = DSA<Node>(indices.size());
+				for (size_t i = 0; i < indices.size(); i++)
+				{
+					path[i] = g.GetVertices()[indices[i]];
+				}
+			}
 			else
 				path = g.DFS(Node(src), Node(dst));
 
@@ -112,6 +120,24 @@ void Game::UpdateModel()
 	}
 }
 
+MappedGraph<uint64_t> Game::LoadGraph()
+{
+	const CsvGraphLayout layout = { SrcColIdx, NeighbourCountColIdx, firstNeighbourColIdx, NeighbourStride };
+	if (!GraphFileIsStale(GraphPath, CsvPath))
+	{
+		try
+		{
+			return MappedGraph<uint64_t>(GraphPath);
+		}
+		catch (const std::runtime_error&)
+		{
+			// unreadable, converted again below
+		}
+	}
+	ConvertCsvToGraphFile(CsvPath, GraphPath, layout);
+	return MappedGraph<uint64_t>(GraphPath);
+}
+
 void Game::ProcessKey(unsigned char key)
 {
 	switch (key)
@@ -27,7 +27,8 @@
 
 #include "Node.h"
 #include "Graph.h"
-#include "RapidCSV.h"
+#include "AllPairsShortestPaths.h"
+#include "GraphCsv.h"
 
 class Game
 {
@@ -44,6 +45,9 @@ private:
 
 	// function to process key presses
 	void ProcessKey(unsigned char key);
+	// maps the graph file, converting the csv into one if there is
+	// no graph file yet, it is older than the csv or it can't be read
+	static MappedGraph<uint64_t> LoadGraph();
 	/********************************/
 private:
 	MainWindow& wnd;
@@ -53,6 +57,8 @@ private:
 	
 	// the graph generated from the file
 	Graph<Node> g;
+	// fewest edge paths between every pair of nodes, built once after loading
+	AllPairsShortestPaths hops;
 	// the source of the highlighted path
 	size_t src = 1;
 	// the destination of the highlighted path
@@ -65,9 +71,11 @@ private:
 	std::string msg = "BFS from 1 to 1";
 	// font used to draw text
 	Font font = Font("Images/Fixedsys16x28.bmp");
-	// used to read csv file
-	rapidcsv::Document doc = rapidcsv::Document("Final Data Structure.csv", rapidcsv::LabelParams());
 	
+	// the file the graph is originally read from
+	static constexpr const char* CsvPath = "Final Data Structure.csv";
+	// binary copy of the graph that is mapped on every start after the first
+	static constexpr const char* GraphPath = "Final Data Structure.graph";
 	// number of vertices in the graph
 	static constexpr size_t NumVertices = 16;
 	// the index of the column in the file with the sources
@@ -76,5 +84,7 @@ private:
 	static constexpr size_t NeighbourCountColIdx = 12;
 	// the index of the column in the file with the first neighbour
 	static constexpr size_t firstNeighbourColIdx = 14;
+	// the number of columns from one neighbour to the next
+	static constexpr size_t NeighbourStride = 3;
 	/********************************/
 };
\ No newline at end of file
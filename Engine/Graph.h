@@ -2,9 +2,14 @@
 
 #include <iostream>
 #include "LinkedList.h"
+#include "Bitset.h"
 #include "DSA.h"
-#include "Queue.h"
-#include "Stack.h"
+#include "VertexHash.h"
+#include "IndexedHeap.h"
+#include "ShortestPath.h"
+#include "Heuristics.h"
+#include "UnionFind.h"
+#include "Permutation.h"
 
 template <typename V>
 class Graph
@@ -25,10 +30,15 @@ public:
 	void AddVertex(const V& val)
 	{
 		assert(!HasVertex(val) && "Attempted to add duplicate vertices");
+		index.Insert(val, verts.size());
 		verts.push_back(val);
 		edges.push_back(SinglyLinkedList<Edge>());
+		in_edges.push_back(SinglyLinkedList<Edge>());
+		components.AddElement();
+		removed.push_back(false);
+		version++;
 	}
-	// creates an undirected edge b/w given vertices
+	// creates a directed edge from src to dst
 	void AddEdge(const V& src, const V& dst, float weight = 0.0f)
 	{
 		const size_t src_idx = GetVertIdx(src);
@@ -36,12 +46,188 @@ public:
 
 		AddEdge_idx(src_idx, dst_idx, weight);
 	}
-	// creates an undirected edge b/w vertices at given indices
+	// creates a directed edge from the src idx to the dst idx
 	void AddEdge_idx(size_t src_idx, size_t dst_idx, float weight = 0.0f)
 	{
 		assert(src_idx < verts.size() && "Vertex does not exist");
 		assert(dst_idx < verts.size() && "Vertex does not exist");
+		assert(!removed.test(src_idx) && !removed.test(dst_idx) && "Vertex was removed");
 		edges[src_idx].push_back({ src_idx, dst_idx, weight });
+		in_edges[dst_idx].push_back({ src_idx, dst_idx, weight });
+		components.Union(src_idx, dst_idx);
+		version++;
+	}
+	// removes every edge from src to dst, returns the num of edges removed
+	size_t RemoveEdge(const V& src, const V& dst)
+	{
+		const size_t src_idx = GetVertIdx(src);
+		const size_t dst_idx = GetVertIdx(dst);
+
+		return RemoveEdge_idx(src_idx, dst_idx);
+	}
+	// removes every edge from the src idx to the dst idx
+	// returns the num of edges removed
+	size_t RemoveEdge_idx(size_t src_idx, size_t dst_idx)
+	{
+		assert(src_idx < verts.size() && "Vertex does not exist");
+		assert(dst_idx < verts.size() && "Vertex does not exist");
+		const size_t count = edges[src_idx].remove_if([dst_idx](const Edge& e) { return e.dst_idx == dst_idx; });
+		in_edges[dst_idx].remove_if([src_idx](const Edge& e) { return e.src_idx == src_idx; });
+		if (count > 0)
+		{
+			// the components may have split, until they are rebuilt they
+			// can only claim too much is connected, never too little
+			components_exact = false;
+			version++;
+		}
+		return count;
+	}
+	// removes a vertex along with every edge touching it
+	void RemoveVertex(const V& val)
+	{
+		RemoveVertex_idx(GetVertIdx(val));
+	}
+	// removes the vertex at given idx along with every edge touching it
+	// the vertex is only marked as removed so the indices of all other
+	// vertices stay the same until the graph is compacted
+	void RemoveVertex_idx(size_t idx)
+	{
+		assert(idx < verts.size() && "Vertex does not exist");
+		assert(!removed.test(idx) && "Vertex was removed");
+
+		for (auto& e : edges[idx])
+		{
+			in_edges[e.dst_idx].remove_if([idx](const Edge& x) { return x.src_idx == idx; });
+		}
+		for (auto& e : in_edges[idx])
+		{
+			edges[e.src_idx].remove_if([idx](const Edge& x) { return x.dst_idx == idx; });
+		}
+		edges[idx].clear();
+		in_edges[idx].clear();
+
+		index.Erase(verts[idx], verts);
+		removed.set(idx);
+		num_removed++;
+		components_exact = false;
+		version++;
+	}
+	// true if enough vertices have been removed that compacting is worth it
+	bool NeedsCompaction() const
+	{
+		return num_removed * 4 > verts.size();
+	}
+	// drops all removed vertices, moving the rest down to fill the gaps
+	// and rebuilds the components, returns the new idx of every old idx
+	// with removed vertices mapped to the new num of vertices
+	DSA<size_t> Compact()
+	{
+		const size_t n = verts.size();
+		const size_t live = n - num_removed;
+		DSA<size_t> remap(n);
+		for (size_t i = 0, next = 0; i < n; i++)
+		{
+			remap[i] = removed.test(i) ? live : next++;
+		}
+
+		DSA<V> new_verts;
+		DSA<SinglyLinkedList<Edge>> new_edges;
+		DSA<SinglyLinkedList<Edge>> new_in_edges;
+		index.clear();
+		for (size_t i = 0; i < n; i++)
+		{
+			if (!removed.test(i))
+			{
+				index.Insert(verts[i], new_verts.size());
+				new_verts.push_back(verts[i]);
+				new_edges.push_back(SinglyLinkedList<Edge>());
+				new_in_edges.push_back(SinglyLinkedList<Edge>());
+			}
+		}
+		for (size_t i = 0; i < n; i++)
+		{
+			// edges of removed vertices are already gone
+			for (auto& e : edges[i])
+			{
+				new_edges[remap[i]].push_back({ remap[i], remap[e.dst_idx], e.weight });
+			}
+			for (auto& e : in_edges[i])
+			{
+				new_in_edges[remap[i]].push_back({ remap[e.src_idx], remap[i], e.weight });
+			}
+			// the lists don't free their nodes on destruction
+			edges[i].clear();
+			in_edges[i].clear();
+		}
+
+		verts = std::move(new_verts);
+		edges = std::move(new_edges);
+		in_edges = std::move(new_in_edges);
+		removed = Bitset(live);
+		num_removed = 0;
+		RebuildComponents();
+		return remap;
+	}
+	// moves every vertex to the idx p gives it, along with its edges
+	// vertex values keep working as before, only indices change
+	void Relabel(const Permutation& p)
+	{
+		const size_t n = verts.size();
+		assert(p.size() == n && "Permutation does not match the graph");
+
+		DSA<V> new_verts(n);
+		DSA<SinglyLinkedList<Edge>> new_edges(n);
+		DSA<SinglyLinkedList<Edge>> new_in_edges(n);
+		Bitset new_removed(n);
+		for (size_t i = 0; i < n; i++)
+		{
+			const size_t ni = p.old_to_new[i];
+			new_verts[ni] = verts[i];
+			for (auto& e : edges[i])
+			{
+				new_edges[ni].push_back({ ni, p.old_to_new[e.dst_idx], e.weight });
+			}
+			for (auto& e : in_edges[i])
+			{
+				new_in_edges[ni].push_back({ p.old_to_new[e.src_idx], ni, e.weight });
+			}
+			if (removed.test(i))
+			{
+				new_removed.set(ni);
+			}
+			// the lists don't free their nodes on destruction
+			edges[i].clear();
+			in_edges[i].clear();
+		}
+
+		index.clear();
+		for (size_t i = 0; i < n; i++)
+		{
+			if (!new_removed.test(i))
+			{
+				index.Insert(new_verts[i], i);
+			}
+		}
+		verts = std::move(new_verts);
+		edges = std::move(new_edges);
+		in_edges = std::move(new_in_edges);
+		removed = std::move(new_removed);
+		RebuildComponents();
+	}
+	// recomputes the components from scratch, needed after removals for
+	// Connected and NumComponents to be exact again
+	void RebuildComponents()
+	{
+		components = UnionFind(verts.size());
+		for (size_t i = 0; i < verts.size(); i++)
+		{
+			for (auto& e : edges[i])
+			{
+				components.Union(i, e.dst_idx);
+			}
+		}
+		components_exact = true;
+		version++;
 	}
 	
 	// performs bredth first search on graph starting at the source node
@@ -68,32 +254,41 @@ public:
 		assert(src_idx < verts.size() && "Vertex does not exist");
 		assert(dst_idx < verts.size() && "Vertex does not exist");
 
-		// queue for bfs
-		LinkedListQueue<DSA<size_t>> q;
-		// push first list onto queue
-		q.push(DSA<size_t>{ 1, src_idx });
-
-		while (!q.empty())
+		// no path can exist between different components
+		if (!components.Connected(src_idx, dst_idx))
 		{
-			// get first path in queue
-			auto path = q.front();
-			q.pop();
+			return DSA<size_t>();
+		}
 
-			if (path.back() == dst_idx)
+		const size_t n = verts.size();
+		// vertices that have already been discovered
+		Bitset visited(n);
+		// the vertex each discovered vertex was first reached from
+		DSA<size_t> pred(n);
+		// every vertex is enqueued at most once so a flat array
+		// with a read and a write cursor is enough for the frontier
+		DSA<size_t> q(n);
+		size_t head = 0, tail = 0;
+
+		visited.set(src_idx);
+		pred[src_idx] = src_idx;
+		q[tail++] = src_idx;
+
+		while (head < tail)
+		{
+			const size_t cur = q[head++];
+			if (cur == dst_idx)
 			{
-				return path;
+				return BuildPath(pred, src_idx, dst_idx);
 			}
 
-			// iterate over all vertices adjacent to the last vertex in the path
-			for (auto& e : edges[path.back()])
+			// discover all unvisited vertices adjacent to the current one
+			for (auto& e : edges[cur])
 			{
-				// if a vertex doesn't form a cycle add it to the path
-				// and push the new path onto the queue
-				if (!path.Has(e.dst_idx))
+				if (!visited.test_and_set(e.dst_idx))
 				{
-					auto temp = path;
-					temp.push_back(e.dst_idx);
-					q.push(temp);
+					pred[e.dst_idx] = cur;
+					q[tail++] = e.dst_idx;
 				}
 			}
 		}
@@ -101,6 +296,138 @@ public:
 		return DSA<size_t>();
 	}
 
+	// performs bredth first search from both the source and the dst node
+	// until the two searches meet, returns the shortest path from source to dst
+	DSA<V> BidirectionalBFS(const V& src, const V& dst) const
+	{
+		const size_t src_idx = GetVertIdx(src);
+		const size_t dst_idx = GetVertIdx(dst);
+
+		const auto& indices = BidirectionalBFS_idx(src_idx, dst_idx);
+		DSA<V> path(indices.size());
+		for (size_t i = 0; i < indices.size(); i++)
+		{
+			path[i] = verts[indices[i]];
+		}
+		return path;
+	}
+	// performs bredth first search forwards from the source idx and backwards
+	// from the dst idx, always growing the smaller frontier by a whole level
+	// until the two meet, returns the shortest path in terms of vertex indices
+	DSA<size_t> BidirectionalBFS_idx(size_t src_idx, size_t dst_idx) const
+	{
+		assert(src_idx < verts.size() && "Vertex does not exist");
+		assert(dst_idx < verts.size() && "Vertex does not exist");
+
+		if (src_idx == dst_idx)
+		{
+			return DSA<size_t>(1, src_idx);
+		}
+		// no path can exist between different components
+		if (!components.Connected(src_idx, dst_idx))
+		{
+			return DSA<size_t>();
+		}
+
+		const size_t n = verts.size();
+		// pred of every vertex reached from src and succ of every vertex
+		// reached from dst, n if the search hasn't reached it
+		DSA<size_t> pred(n, n);
+		DSA<size_t> succ(n, n);
+		// hop counts from src and to dst
+		DSA<size_t> fwd_dist(n);
+		DSA<size_t> bwd_dist(n);
+		DSA<size_t> fwd_q(n);
+		DSA<size_t> bwd_q(n);
+		size_t fwd_head = 0, fwd_tail = 0;
+		size_t bwd_head = 0, bwd_tail = 0;
+
+		pred[src_idx] = src_idx;
+		fwd_dist[src_idx] = 0;
+		fwd_q[fwd_tail++] = src_idx;
+		succ[dst_idx] = dst_idx;
+		bwd_dist[dst_idx] = 0;
+		bwd_q[bwd_tail++] = dst_idx;
+
+		// the shortest edge found so far joining the two searches
+		size_t best_len = ~size_t(0);
+		size_t meet_from = n, meet_to = n;
+
+		while (fwd_head < fwd_tail && bwd_head < bwd_tail && meet_from == n)
+		{
+			// every edge out of the expanded level is checked against the
+			// other side before stopping, so the best meeting edge is found
+			if (fwd_tail - fwd_head <= bwd_tail - bwd_head)
+			{
+				for (const size_t level_end = fwd_tail; fwd_head < level_end; fwd_head++)
+				{
+					const size_t cur = fwd_q[fwd_head];
+					for (auto& e : edges[cur])
+					{
+						const size_t nbr = e.dst_idx;
+						if (pred[nbr] == n)
+						{
+							pred[nbr] = cur;
+							fwd_dist[nbr] = fwd_dist[cur] + 1;
+							fwd_q[fwd_tail++] = nbr;
+						}
+						if (succ[nbr] != n && fwd_dist[cur] + 1 + bwd_dist[nbr] < best_len)
+						{
+							best_len = fwd_dist[cur] + 1 + bwd_dist[nbr];
+							meet_from = cur;
+							meet_to = nbr;
+						}
+					}
+				}
+			}
+			else
+			{
+				for (const size_t level_end = bwd_tail; bwd_head < level_end; bwd_head++)
+				{
+					const size_t cur = bwd_q[bwd_head];
+					for (auto& e : in_edges[cur])
+					{
+						const size_t nbr = e.src_idx;
+						if (succ[nbr] == n)
+						{
+							succ[nbr] = cur;
+							bwd_dist[nbr] = bwd_dist[cur] + 1;
+							bwd_q[bwd_tail++] = nbr;
+						}
+						if (pred[nbr] != n && fwd_dist[nbr] + 1 + bwd_dist[cur] < best_len)
+						{
+							best_len = fwd_dist[nbr] + 1 + bwd_dist[cur];
+							meet_from = nbr;
+							meet_to = cur;
+						}
+					}
+				}
+			}
+		}
+
+		if (meet_from == n)
+		{
+			return DSA<size_t>();
+		}
+
+		// src .. meet_from comes from the forward search
+		// meet_to .. dst comes from the backward search
+		DSA<size_t> path(best_len + 1);
+		size_t i = fwd_dist[meet_from];
+		for (size_t v = meet_from; v != src_idx; v = pred[v])
+		{
+			path[i--] = v;
+		}
+		path[0] = src_idx;
+		i = fwd_dist[meet_from] + 1;
+		for (size_t v = meet_to; v != dst_idx; v = succ[v])
+		{
+			path[i++] = v;
+		}
+		path[i] = dst_idx;
+		return path;
+	}
+
 	// performs depth first search on graph starting at the given source node
 	// until the dst node is found, returns path from source to dst
 	// will most likely NOT return the shortest path
@@ -125,45 +452,151 @@ public:
 		assert(src_idx < verts.size() && "Vertex does not exist");
 		assert(dst_idx < verts.size() && "Vertex does not exist");
 
-		// stack for dfs
-		LinkedListStack<DSA<size_t>> s;
-		// push first list onto stack
-		s.push(DSA<size_t>{ 1, src_idx });
+		if (src_idx == dst_idx)
+		{
+			return DSA<size_t>(1, src_idx);
+		}
+		// no path can exist between different components
+		if (!components.Connected(src_idx, dst_idx))
+		{
+			return DSA<size_t>();
+		}
+
+		const size_t n = verts.size();
+		// vertices that have already been pushed onto the path
+		Bitset visited(n);
+		// the current path, each frame remembers how far into its
+		// adj list the search has gotten so no edge is looked at twice
+		DSA<DfsFrame> s(n);
+		size_t depth = 0;
+
+		visited.set(src_idx);
+		s[depth++] = DfsFrame{ src_idx, edges[src_idx].begin() };
 
-		while (!s.empty())
+		while (depth > 0)
 		{
-			// get first path in stack
-			auto path = s.top();
-			s.pop();
+			DfsFrame& top = s[depth - 1];
+			// all neighbours explored, backtrack
+			if (top.next == edges[top.idx].end())
+			{
+				depth--;
+				continue;
+			}
 
-			if (path.back() == dst_idx)
+			const size_t nbr = top.next->dst_idx;
+			++top.next;
+			if (visited.test_and_set(nbr))
 			{
-				return path;
+				continue;
 			}
 
-			// iterate over all vertices adjacent to the last vertex in the path
-			for (auto& e : edges[path.back()])
+			if (nbr == dst_idx)
 			{
-				// if a vertex doesn't form a cycle add it to the path
-				// and push the new path onto the stack
-				if (!path.Has(e.dst_idx))
+				// the frames on the stack are the path to dst
+				DSA<size_t> path(depth + 1);
+				for (size_t i = 0; i < depth; i++)
 				{
-					auto temp = path;
-					temp.push_back(e.dst_idx);
-					s.push(temp);
+					path[i] = s[i].idx;
 				}
+				path[depth] = dst_idx;
+				return path;
 			}
+			s[depth++] = DfsFrame{ nbr, edges[nbr].begin() };
 		}
 
 		return DSA<size_t>();
 	}
 	
+	// finds the shortest path from the source idx to the dst idx
+	// where the length of a path is the sum of its edge weights
+	// weights must not be negative
+	WeightedPath Dijkstra_idx(size_t src_idx, size_t dst_idx) const
+	{
+		assert(dst_idx < verts.size() && "Vertex does not exist");
+		if (!Connected_idx(src_idx, dst_idx))
+		{
+			return WeightedPath();
+		}
+		return RunDijkstra(src_idx, dst_idx).PathTo(dst_idx);
+	}
+	// finds the shortest paths from the source idx to every vertex
+	// where the length of a path is the sum of its edge weights
+	// weights must not be negative
+	ShortestPathTree DijkstraAll_idx(size_t src_idx) const
+	{
+		return RunDijkstra(src_idx, verts.size());
+	}
+
+	// finds the shortest path from the source idx to the dst idx with A* search
+	// using the position of the vertices as the heuristic if they have one
+	WeightedPath AStar_idx(size_t src_idx, size_t dst_idx) const
+	{
+		return AStar_idx(src_idx, dst_idx, DefaultHeuristic<V>(verts));
+	}
+	// finds the shortest path from the source idx to the dst idx with A* search
+	// the heuristic is called as h(idx, dst_idx) and must never overestimate
+	// the remaining distance for the returned path to be the shortest
+	template <typename Heuristic>
+	WeightedPath AStar_idx(size_t src_idx, size_t dst_idx, const Heuristic& h) const
+	{
+		assert(src_idx < verts.size() && "Vertex does not exist");
+		assert(dst_idx < verts.size() && "Vertex does not exist");
+
+		if (!components.Connected(src_idx, dst_idx))
+		{
+			return WeightedPath();
+		}
+
+		const size_t n = verts.size();
+		// dist holds the best known distance from src to each vertex
+		ShortestPathTree tree(src_idx, n);
+		// keyed on the estimated length of a path through each vertex
+		IndexedHeap<> open(n);
+
+		tree.dist[src_idx] = 0.0f;
+		tree.pred[src_idx] = src_idx;
+		open.push(src_idx, h(src_idx, dst_idx));
+
+		while (!open.empty())
+		{
+			const size_t cur = open.top();
+			open.pop();
+			if (cur == dst_idx)
+			{
+				return tree.PathTo(dst_idx);
+			}
+
+			const float d = tree.dist[cur];
+			for (auto& e : edges[cur])
+			{
+				assert(e.weight >= 0.0f && "Negative edge weight");
+				const float nd = d + e.weight;
+				if (nd < tree.dist[e.dst_idx])
+				{
+					tree.dist[e.dst_idx] = nd;
+					tree.pred[e.dst_idx] = cur;
+					// a vertex that was already closed is reopened, which
+					// can only happen if the heuristic is inconsistent
+					const float f = nd + h(e.dst_idx, dst_idx);
+					if (open.contains(e.dst_idx))
+						open.decrease(e.dst_idx, f);
+					else
+						open.push(e.dst_idx, f);
+				}
+			}
+		}
+
+		return WeightedPath();
+	}
+
 	// returns all vertices stored in the graph
+	// removed vertices stay in place until the graph is compacted
 	const DSA<V>& GetVertices() const
 	{
 		return verts;
 	}
 	// returns all vertices stored in the graph (non-const version)
+	// vertices must not be modified in a way that changes their equality or hash
 	DSA<V>& GetVertices()
 	{
 		return verts;
@@ -189,25 +622,133 @@ public:
 		return edges[idx];
 	}
 
+	// returns list of edges ending at vertex at given idx
+	const SinglyLinkedList<Edge>& GetInAdjList_idx(size_t idx) const
+	{
+		return in_edges[idx];
+	}
+
 	// returs the index of a given vertex
 	// if vertex does not exist, returns the size of the vertex array
 	size_t GetVertIdx(const V& val) const
 	{
-		for (size_t i = 0; i < verts.size(); i++)
-		{
-			if (val == verts[i])
-				return i;
-		}
-		return verts.size();
+		return index.Find(val, verts);
+	}
+	// true if the two vertices are joined by edges in some direction
+	// a path between them can only exist if this holds
+	// after removals this may be true for vertices that are no longer
+	// joined until the components are rebuilt
+	bool Connected(const V& a, const V& b) const
+	{
+		return Connected_idx(GetVertIdx(a), GetVertIdx(b));
+	}
+	// true if the vertices at given indices are joined by edges in some direction
+	bool Connected_idx(size_t a_idx, size_t b_idx) const
+	{
+		assert(a_idx < verts.size() && "Vertex does not exist");
+		assert(b_idx < verts.size() && "Vertex does not exist");
+		return components.Connected(a_idx, b_idx);
+	}
+	// num of connected components, ignoring edge directions
+	// counts every removed vertex as a component of its own
+	// and may be too low after removals until the components are rebuilt
+	size_t NumComponents() const
+	{
+		return components.NumSets();
+	}
+	// false if edges were removed since the components were last rebuilt
+	bool ComponentsExact() const
+	{
+		return components_exact;
+	}
+	// true if the vertex at given idx was removed and not yet compacted away
+	bool IsRemoved_idx(size_t idx) const
+	{
+		return removed.test(idx);
+	}
+	// num of removed vertices still taking up an idx
+	size_t NumRemoved() const
+	{
+		return num_removed;
+	}
+	// incremented on every change to the graph, structures derived from it
+	// can compare this to tell if they are out of date
+	// changes made through the non-const adj lists are not counted
+	size_t Version() const
+	{
+		return version;
 	}
 	// check if a vertex already exists
-	bool HasVertex(const V& val)
+	bool HasVertex(const V& val) const
+	{
+		return GetVertIdx(val) != verts.size();
+	}
+
+private:
+	// dijkstra's algorithm from src, stops early once stop_idx is settled
+	ShortestPathTree RunDijkstra(size_t src_idx, size_t stop_idx) const
 	{
-		return verts.Has(val);
+		assert(src_idx < verts.size() && "Vertex does not exist");
+
+		const size_t n = verts.size();
+		ShortestPathTree tree(src_idx, n);
+		IndexedHeap<> heap(n);
+
+		tree.dist[src_idx] = 0.0f;
+		tree.pred[src_idx] = src_idx;
+		heap.push(src_idx, 0.0f);
+
+		while (!heap.empty())
+		{
+			// the closest unsettled vertex, its distance is now final
+			const size_t cur = heap.top();
+			const float d = heap.top_key();
+			heap.pop();
+			if (cur == stop_idx)
+			{
+				break;
+			}
+
+			for (auto& e : edges[cur])
+			{
+				assert(e.weight >= 0.0f && "Negative edge weight");
+				const float nd = d + e.weight;
+				if (nd < tree.dist[e.dst_idx])
+				{
+					tree.dist[e.dst_idx] = nd;
+					tree.pred[e.dst_idx] = cur;
+					if (heap.contains(e.dst_idx))
+						heap.decrease(e.dst_idx, nd);
+					else
+						heap.push(e.dst_idx, nd);
+				}
+			}
+		}
+
+		return tree;
 	}
 
+	// a vertex on the dfs path along with the next edge to explore from it
+	struct DfsFrame
+	{
+		size_t idx;
+		typename SinglyLinkedList<Edge>::const_iterator next;
+	};
+
 private:
 	DSA<V> verts;
 	DSA<SinglyLinkedList<Edge>> edges;
+	// edges[i] with every edge filed under its dst instead of its src
+	DSA<SinglyLinkedList<Edge>> in_edges;
+	// maps vertex values to their index in verts
+	VertexIndex<V> index;
+	// weakly connected components, kept up to date as edges are added
+	// and only rebuilt on request after removals
+	UnionFind components;
+	bool components_exact = true;
+	// set for every removed vertex
+	Bitset removed;
+	size_t num_removed = 0;
+	size_t version = 0;
 };
 
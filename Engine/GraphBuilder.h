@@ -0,0 +1,358 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include "CsrGraph.h"
+#include "Graph.h"
+#include "ThreadPool.h"
+
+// what to do with edges that have the same src and dst
+enum class ParallelEdges
+{
+	// keep every one of them
+	Keep,
+	// keep only the one added first
+	First,
+	// keep one with the least of their weights
+	MinWeight,
+	// keep one with the sum of their weights
+	SumWeight
+};
+
+// collects an unordered list of edges and turns it into a graph in one go
+// the edges are radix sorted by (src, dst) across a thread pool, so every
+// adjacency list comes out sorted by dst and parallel edges end up next to
+// each other where they are merged
+// vertex indices have to be below UINT32_MAX, so that the num of vertices
+// fits in 32 bits and a key src * n + dst in 64
+class GraphBuilder
+{
+public:
+	// builder for a graph of at least num_verts vertices, the graph grows
+	// to fit any edge that touches a higher idx
+	explicit GraphBuilder(size_t num_verts = 0)
+		:
+		num_verts(num_verts),
+		srcs(0),
+		dsts(0),
+		weights(0)
+	{}
+
+	// makes room for num_edges edges in total so adding them doesn't reallocate
+	void Reserve(size_t num_edges)
+	{
+		if (num_edges > srcs.capacity())
+		{
+			srcs.resize(num_edges);
+			dsts.resize(num_edges);
+			weights.resize(num_edges);
+		}
+	}
+	// makes sure the graph has a vertex at given idx, even if no edge touches it
+	void AddVertex(size_t idx)
+	{
+		assert(idx < UINT32_MAX && "Vertex idx does not fit in 32 bits");
+		num_verts = std::max(num_verts, idx + 1);
+	}
+	// adds a directed edge from the src idx to the dst idx
+	void AddEdge(size_t src_idx, size_t dst_idx, float weight = 0.0f)
+	{
+		assert(src_idx < UINT32_MAX && dst_idx < UINT32_MAX && "Vertex idx does not fit in 32 bits");
+		srcs.push_back(uint32_t(src_idx));
+		dsts.push_back(uint32_t(dst_idx));
+		weights.push_back(weight);
+		num_verts = std::max(num_verts, std::max(src_idx, dst_idx) + 1);
+	}
+	// adds every edge of an edge list
+	void AddEdges(const DSA<CsrGraph::Edge>& edge_list)
+	{
+		Reserve(srcs.size() + edge_list.size());
+		for (auto& e : edge_list)
+		{
+			AddEdge(e.src_idx, e.dst_idx, e.weight);
+		}
+	}
+	// adds count edges made across the pool, edge i being make_edge(i)
+	// make_edge must be safe to call from several threads at once, the
+	// edges are stored in order of i however the work is split
+	template <typename F>
+	void AddEdges(size_t count, ThreadPool& pool, const F& make_edge)
+	{
+		const size_t first = srcs.size();
+		Reserve(first + count);
+		srcs.resize(first + count);
+		dsts.resize(first + count);
+		weights.resize(first + count);
+
+		DSA<size_t> thread_verts(pool.size(), 0);
+		pool.ParallelFor(count, AddGrain, [&](size_t t, size_t begin, size_t end)
+		{
+			size_t verts = 0;
+			for (size_t i = begin; i < end; i++)
+			{
+				const CsrGraph::Edge e = make_edge(i);
+				assert(e.src_idx < UINT32_MAX && e.dst_idx < UINT32_MAX && "Vertex idx does not fit in 32 bits");
+				srcs.data()[first + i] = uint32_t(e.src_idx);
+				dsts.data()[first + i] = uint32_t(e.dst_idx);
+				weights.data()[first + i] = e.weight;
+				verts = std::max(verts, std::max(e.src_idx, e.dst_idx) + 1);
+			}
+			thread_verts[t] = std::max(thread_verts[t], verts);
+		});
+		for (size_t t = 0; t < pool.size(); t++)
+		{
+			num_verts = std::max(num_verts, thread_verts[t]);
+		}
+	}
+	// sets what is done with parallel edges, they are all kept by default
+	GraphBuilder& MergeParallelEdges(ParallelEdges policy)
+	{
+		merge = policy;
+		return *this;
+	}
+	// if set every edge is also added in reverse, self loops only once
+	GraphBuilder& Symmetrize(bool symmetric = true)
+	{
+		symmetrize = symmetric;
+		return *this;
+	}
+
+	// num of vertices the graph will have
+	size_t NumVertices() const
+	{
+		return num_verts;
+	}
+	// num of edges added so far
+	size_t NumEdges() const
+	{
+		return srcs.size();
+	}
+
+	// builds the csr graph of every edge added, each array is allocated
+	// once at its final size
+	CsrGraph BuildCsr(ThreadPool& pool) const
+	{
+		const size_t n = num_verts;
+		const size_t num_threads = pool.size();
+		// n * n must not wrap, else the keys are out of order and the sort skips passes
+		assert(n <= UINT32_MAX && "Too many vertices for 64 bit keys");
+
+		// every edge as its key src * n + dst, reversed ones after the rest
+		DSA<size_t> loops(num_threads + 1, 0);
+		if (symmetrize)
+		{
+			pool.RunOnAll([&](size_t t)
+			{
+				size_t count = 0;
+				for (size_t i = Begin(srcs.size(), t, num_threads); i < Begin(srcs.size(), t + 1, num_threads); i++)
+				{
+					count += srcs.data()[i] != dsts.data()[i];
+				}
+				loops[t + 1] = count;
+			});
+			for (size_t t = 0; t < num_threads; t++)
+			{
+				loops[t + 1] += loops[t];
+			}
+		}
+		const size_t m = srcs.size() + loops[num_threads];
+		DSA<uint64_t> key_arr(m);
+		DSA<float> val_arr(m);
+		pool.RunOnAll([&](size_t t)
+		{
+			// the arrays are read through raw pointers in the loops that
+			// touch every edge to skip the bounds checks
+			const uint32_t* const s = srcs.data();
+			const uint32_t* const d = dsts.data();
+			uint64_t* const keys = key_arr.data();
+			float* const vals = val_arr.data();
+			size_t rev = srcs.size() + loops[t];
+			for (size_t i = Begin(srcs.size(), t, num_threads); i < Begin(srcs.size(), t + 1, num_threads); i++)
+			{
+				keys[i] = uint64_t(s[i]) * n + d[i];
+				vals[i] = weights.data()[i];
+				if (symmetrize && s[i] != d[i])
+				{
+					keys[rev] = uint64_t(d[i]) * n + s[i];
+					vals[rev] = weights.data()[i];
+					rev++;
+				}
+			}
+		});
+
+		RadixSort(key_arr, val_arr, uint64_t(n) * n, pool);
+		const uint64_t* const keys = key_arr.data();
+		const float* const vals = val_arr.data();
+
+		// the first edge of every run of equal keys is a head and the only
+		// one kept, unless every edge is kept
+		const bool keep_all = merge == ParallelEdges::Keep;
+		const auto is_head = [&](size_t i)
+		{
+			return keep_all || i == 0 || keys[i] != keys[i - 1];
+		};
+		DSA<size_t> heads(num_threads + 1, 0);
+		pool.RunOnAll([&](size_t t)
+		{
+			size_t count = 0;
+			for (size_t i = Begin(m, t, num_threads); i < Begin(m, t + 1, num_threads); i++)
+			{
+				count += is_head(i);
+			}
+			heads[t + 1] = count;
+		});
+		for (size_t t = 0; t < num_threads; t++)
+		{
+			heads[t + 1] += heads[t];
+		}
+
+		const size_t num_edges = heads[num_threads];
+		DSA<size_t> offsets(n + 1);
+		DSA<size_t> targets(num_edges);
+		DSA<float> out_weights(num_edges);
+		pool.RunOnAll([&](size_t t)
+		{
+			size_t* const offs = offsets.data();
+			size_t* const tgts = targets.data();
+			float* const ws = out_weights.data();
+			size_t k = heads[t];
+			for (size_t i = Begin(m, t, num_threads); i < Begin(m, t + 1, num_threads); i++)
+			{
+				if (!is_head(i))
+				{
+					continue;
+				}
+				const size_t src = size_t(keys[i] / n);
+				// every vertex after the src of the edge before and up to this
+				// src starts here, the runs are sorted by src
+				const size_t first_v = i == 0 ? 0 : size_t(keys[i - 1] / n) + 1;
+				for (size_t v = first_v; v <= src; v++)
+				{
+					offs[v] = k;
+				}
+				tgts[k] = size_t(keys[i] % n);
+				// a run is merged by the thread with its head, even if it
+				// runs on past the end of that thread's range
+				float w = vals[i];
+				for (size_t j = i + 1; !keep_all && j < m && keys[j] == keys[i]; j++)
+				{
+					if (merge == ParallelEdges::MinWeight)
+					{
+						w = std::min(w, vals[j]);
+					}
+					else if (merge == ParallelEdges::SumWeight)
+					{
+						w += vals[j];
+					}
+				}
+				ws[k] = w;
+				k++;
+			}
+		});
+		// vertices after the src of the last edge have no edges
+		for (size_t v = m == 0 ? 0 : size_t(keys[m - 1] / n) + 1; v <= n; v++)
+		{
+			offsets[v] = num_edges;
+		}
+
+		return CsrGraph(std::move(offsets), std::move(targets), std::move(out_weights));
+	}
+	// adds every edge to g, which must already have all the vertices
+	// edges are added grouped by src and sorted by dst
+	template <typename V>
+	void BuildInto(Graph<V>& g, ThreadPool& pool) const
+	{
+		assert(num_verts <= g.GetVertices().size() && "Vertex does not exist");
+		const CsrGraph csr = BuildCsr(pool);
+		for (size_t src = 0; src < csr.NumVertices(); src++)
+		{
+			for (size_t k = csr.EdgesBegin(src); k < csr.EdgesEnd(src); k++)
+			{
+				g.AddEdge_idx(src, csr.Target(k), csr.Weight(k));
+			}
+		}
+	}
+
+private:
+	// first item of thread t when count items are split evenly
+	static size_t Begin(size_t count, size_t t, size_t num_threads)
+	{
+		return size_t(uint64_t(count) * t / num_threads);
+	}
+	// stable lsd radix sort of keys, all less than key_end, with vals
+	// moved along, every thread sorts its own range of each pass into
+	// the spots a shared histogram gives it
+	static void RadixSort(DSA<uint64_t>& keys, DSA<float>& vals, uint64_t key_end, ThreadPool& pool)
+	{
+		const size_t m = keys.size();
+		const size_t num_threads = pool.size();
+		DSA<uint64_t> keys_tmp(m);
+		DSA<float> vals_tmp(m);
+		DSA<size_t> hist(num_threads * Buckets);
+
+		for (unsigned shift = 0; shift < 64 && key_end > uint64_t(1) << shift; shift += RadixBits)
+		{
+			pool.RunOnAll([&](size_t t)
+			{
+				size_t* const h = hist.data() + t * Buckets;
+				const uint64_t* const src = keys.data();
+				std::fill(h, h + Buckets, size_t(0));
+				for (size_t i = Begin(m, t, num_threads); i < Begin(m, t + 1, num_threads); i++)
+				{
+					h[(src[i] >> shift) & (Buckets - 1)]++;
+				}
+			});
+
+			// where every thread writes each digit, digits in order and
+			// threads in order within a digit keep the sort stable
+			size_t pos = 0;
+			bool one_digit = false;
+			for (size_t d = 0; d < Buckets; d++)
+			{
+				const size_t digit_start = pos;
+				for (size_t t = 0; t < num_threads; t++)
+				{
+					const size_t count = hist[t * Buckets + d];
+					hist[t * Buckets + d] = pos;
+					pos += count;
+				}
+				one_digit |= pos - digit_start == m;
+			}
+			// every key has the same digit, the pass would change nothing
+			if (one_digit)
+			{
+				continue;
+			}
+
+			pool.RunOnAll([&](size_t t)
+			{
+				size_t* const h = hist.data() + t * Buckets;
+				const uint64_t* const src_keys = keys.data();
+				const float* const src_vals = vals.data();
+				uint64_t* const dst_keys = keys_tmp.data();
+				float* const dst_vals = vals_tmp.data();
+				for (size_t i = Begin(m, t, num_threads); i < Begin(m, t + 1, num_threads); i++)
+				{
+					const size_t k = h[(src_keys[i] >> shift) & (Buckets - 1)]++;
+					dst_keys[k] = src_keys[i];
+					dst_vals[k] = src_vals[i];
+				}
+			});
+			std::swap(keys, keys_tmp);
+			std::swap(vals, vals_tmp);
+		}
+	}
+
+private:
+	static constexpr unsigned RadixBits = 11;
+	static constexpr size_t Buckets = size_t(1) << RadixBits;
+	// num of edges a thread makes at a time in AddEdges
+	static constexpr size_t AddGrain = 1 << 14;
+	size_t num_verts;
+	// the edges in the order they were added
+	DSA<uint32_t> srcs;
+	DSA<uint32_t> dsts;
+	DSA<float> weights;
+	ParallelEdges merge = ParallelEdges::Keep;
+	bool symmetrize = false;
+};
@@ -0,0 +1,74 @@
+#pragma once
+#include <stdexcept>
+#include <string>
+#include "GraphBuilder.h"
+#include "GraphFile.h"
+#include "RapidCSV.h"
+
+// where a csv file with one row per vertex keeps the adjacency
+struct CsvGraphLayout
+{
+	// column with the num of the row's vertex
+	size_t src_col;
+	// column with the num of neighbours of the row's vertex
+	size_t count_col;
+	// column with the first neighbour, the rest follow every nbr_stride columns
+	size_t first_nbr_col;
+	size_t nbr_stride;
+};
+
+// converts a csv file laid out as given into a graph file
+// vertices are numbered from 1 in the csv and vertex num i is stored at idx
+// i - 1 with i as its payload, the csv repeats rows so parallel edges
+// are merged
+inline void ConvertCsvToGraphFile(const std::string& csv_path, const std::string& graph_path, const CsvGraphLayout& layout)
+{
+	const rapidcsv::Document doc(csv_path, rapidcsv::LabelParams());
+	const size_t rows = doc.GetRowCount();
+
+	GraphBuilder builder;
+	for (size_t i = 0; i < rows; i++)
+	{
+		const size_t src = doc.GetCell<size_t>(layout.src_col, i);
+		if (src == 0)
+		{
+			throw std::runtime_error("Vertex nums in " + csv_path + " must start at 1");
+		}
+		const size_t num_nbrs = doc.GetCell<size_t>(layout.count_col, i);
+		for (size_t j = 0; j < num_nbrs; j++)
+		{
+			const size_t nbr = doc.GetCell<size_t>(layout.first_nbr_col + layout.nbr_stride * j, i);
+			if (nbr == 0)
+			{
+				throw std::runtime_error("Vertex nums in " + csv_path + " must start at 1");
+			}
+			builder.AddEdge(src - 1, nbr - 1);
+		}
+		// a vertex with no neighbours still has to be in the graph
+		builder.AddVertex(src - 1);
+	}
+
+	ThreadPool pool;
+	const CsrGraph g = builder.MergeParallelEdges(ParallelEdges::First).BuildCsr(pool);
+	const size_t num_verts = g.NumVertices();
+	DSA<uint64_t> nums(num_verts);
+	for (size_t v = 0; v < num_verts; v++)
+	{
+		nums[v] = v + 1;
+	}
+	GraphFile::Write(graph_path, g, nums);
+}
+
+// true if graph_path has to be converted from csv_path again, because it
+// doesn't exist or the csv has been written to since
+// times only have a resolution of a second on some systems, so a graph
+// file written in the same second as the csv counts as stale
+inline bool GraphFileIsStale(const std::string& graph_path, const std::string& csv_path)
+{
+	int64_t graph_time, csv_time;
+	if (!LastWriteTime(graph_path, graph_time))
+	{
+		return true;
+	}
+	return LastWriteTime(csv_path, csv_time) && csv_time >= graph_time;
+}
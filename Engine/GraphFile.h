@@ -0,0 +1,396 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#ifdef _WIN32
+#include "ChiliWin.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "CsrGraph.h"
+
+// read only view of a whole file mapped into memory
+// pages are only read from disk when they are first touched
+class MappedFile
+{
+public:
+	// maps the file at given path, throws if it can't be opened or mapped
+	explicit MappedFile(const std::string& path)
+	{
+#ifdef _WIN32
+		file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			throw std::runtime_error("Unable to open " + path);
+		}
+		LARGE_INTEGER file_size;
+		if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+		{
+			CloseHandle(file);
+			throw std::runtime_error("Unable to map " + path);
+		}
+		length = size_t(file_size.QuadPart);
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping != nullptr)
+		{
+			ptr = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+		}
+		if (ptr == nullptr)
+		{
+			if (mapping != nullptr)
+			{
+				CloseHandle(mapping);
+			}
+			CloseHandle(file);
+			throw std::runtime_error("Unable to map " + path);
+		}
+#else
+		fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+		{
+			throw std::runtime_error("Unable to open " + path);
+		}
+		struct stat st;
+		if (fstat(fd, &st) != 0 || st.st_size == 0)
+		{
+			close(fd);
+			throw std::runtime_error("Unable to map " + path);
+		}
+		length = size_t(st.st_size);
+		void* const addr = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+		if (addr == MAP_FAILED)
+		{
+			close(fd);
+			throw std::runtime_error("Unable to map " + path);
+		}
+		ptr = static_cast<const char*>(addr);
+#endif
+	}
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile()
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(ptr);
+		CloseHandle(mapping);
+		CloseHandle(file);
+#else
+		munmap(const_cast<char*>(ptr), length);
+		close(fd);
+#endif
+	}
+
+	// first byte of the file
+	const char* data() const
+	{
+		return ptr;
+	}
+	// num of bytes in the file
+	size_t size() const
+	{
+		return length;
+	}
+
+private:
+#ifdef _WIN32
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = nullptr;
+#else
+	int fd = -1;
+#endif
+	const char* ptr = nullptr;
+	size_t length = 0;
+};
+
+template <typename V>
+class MappedGraph;
+
+// last write time of the file at path, in units that depend on the os
+// returns false if there is no such file
+inline bool LastWriteTime(const std::string& path, int64_t& time)
+{
+#ifdef _WIN32
+	WIN32_FILE_ATTRIBUTE_DATA attr;
+	if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &attr))
+	{
+		return false;
+	}
+	time = int64_t(uint64_t(attr.ftLastWriteTime.dwHighDateTime) << 32 | attr.ftLastWriteTime.dwLowDateTime);
+#else
+	struct stat st;
+	if (stat(path.c_str(), &st) != 0)
+	{
+		return false;
+	}
+	time = int64_t(st.st_mtime);
+#endif
+	return true;
+}
+
+// the start of a graph file, followed by the csr arrays and the vertex
+// payloads, each starting at a multiple of 64 bytes
+// indices are stored as 64 bit and everything is in the byte order of the
+// machine that wrote the file, the magic reads byte swapped on the other
+struct GraphFileHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t num_verts;
+	uint64_t num_edges;
+	// bytes per vertex payload, 0 if the file has none
+	uint64_t payload_size;
+	// byte positions of the arrays from the start of the file
+	uint64_t offsets_pos;
+	uint64_t targets_pos;
+	uint64_t weights_pos;
+	uint64_t payloads_pos;
+};
+
+// reads and writes graph files
+// a file is loaded by mapping it and pointing a csr graph at its arrays,
+// so opening even a huge graph takes no time and no parsing
+class GraphFile
+{
+	template <typename V>
+	friend class MappedGraph;
+
+public:
+	// writes g to a graph file with no vertex payloads
+	static void Write(const std::string& path, const CsrGraph& g)
+	{
+		Write(path, g, nullptr, 0);
+	}
+	// writes g to a graph file along with one payload per vertex
+	// the payloads are stored as raw bytes so V must be trivially copyable
+	template <typename V>
+	static void Write(const std::string& path, const CsrGraph& g, const DSA<V>& payloads)
+	{
+		static_assert(std::is_trivially_copyable<V>::value, "Vertex payloads must be trivially copyable");
+		assert(payloads.size() == g.NumVertices() && "One payload per vertex is needed");
+		Write(path, g, reinterpret_cast<const char*>(payloads.data()), sizeof(V));
+	}
+	// maps a graph file and returns its graph without copying the arrays
+	// the mapping stays open for as long as the graph or any copy of it lives
+	// checking the contents reads the whole file, files known to be valid
+	// (written by this process, or checked already) can skip it
+	static CsrGraph Map(const std::string& path, bool check_contents = true)
+	{
+		return View(std::make_shared<MappedFile>(path), check_contents);
+	}
+
+private:
+	static uint64_t AlignUp(uint64_t pos)
+	{
+		return (pos + Align - 1) / Align * Align;
+	}
+	static void Pad(std::ostream& out, uint64_t pos)
+	{
+		for (uint64_t i = pos; i < AlignUp(pos); i++)
+		{
+			out.put('\0');
+		}
+	}
+	static void Write(const std::string& path, const CsrGraph& g, const char* payloads, uint64_t payload_size)
+	{
+		const uint64_t n = g.NumVertices();
+		const uint64_t m = g.NumEdges();
+		GraphFileHeader header;
+		header.magic = Magic;
+		header.version = Version;
+		header.num_verts = n;
+		header.num_edges = m;
+		header.payload_size = payload_size;
+		header.offsets_pos = AlignUp(sizeof(GraphFileHeader));
+		header.targets_pos = AlignUp(header.offsets_pos + (n + 1) * sizeof(uint64_t));
+		header.weights_pos = AlignUp(header.targets_pos + m * sizeof(uint64_t));
+		header.payloads_pos = AlignUp(header.weights_pos + m * sizeof(float));
+
+		std::ofstream out(path, std::ios::binary);
+		if (!out)
+		{
+			throw std::runtime_error("Unable to create " + path);
+		}
+		out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		Pad(out, sizeof(header));
+		for (uint64_t v = 0; v <= n; v++)
+		{
+			const uint64_t off = v < n ? g.EdgesBegin(size_t(v)) : m;
+			out.write(reinterpret_cast<const char*>(&off), sizeof(off));
+		}
+		Pad(out, header.offsets_pos + (n + 1) * sizeof(uint64_t));
+		for (uint64_t k = 0; k < m; k++)
+		{
+			const uint64_t target = g.Target(size_t(k));
+			out.write(reinterpret_cast<const char*>(&target), sizeof(target));
+		}
+		Pad(out, header.targets_pos + m * sizeof(uint64_t));
+		for (uint64_t k = 0; k < m; k++)
+		{
+			const float weight = g.Weight(size_t(k));
+			out.write(reinterpret_cast<const char*>(&weight), sizeof(weight));
+		}
+		Pad(out, header.weights_pos + m * sizeof(float));
+		out.write(payloads, std::streamsize(n * payload_size));
+		if (!out)
+		{
+			throw std::runtime_error("Unable to write " + path);
+		}
+	}
+	// checks the header and that every array lies inside the file, and if
+	// asked that the arrays are a csr graph, so traversals stay in bounds
+	static const GraphFileHeader& Validate(const MappedFile& file, bool check_contents)
+	{
+		if (file.size() < sizeof(GraphFileHeader))
+		{
+			throw std::runtime_error("Graph file is truncated");
+		}
+		const GraphFileHeader& h = *reinterpret_cast<const GraphFileHeader*>(file.data());
+		if (h.magic == SwappedMagic)
+		{
+			throw std::runtime_error("Graph file was written with the other byte order");
+		}
+		if (h.magic != Magic)
+		{
+			throw std::runtime_error("Not a graph file");
+		}
+		if (h.version != Version)
+		{
+			throw std::runtime_error("Unsupported graph file version");
+		}
+		const uint64_t size = file.size();
+		// true if count elements of elem_size bytes at pos are inside the file
+		// written with divisions so a corrupt header can't overflow it
+		const auto fits = [size](uint64_t pos, uint64_t count, uint64_t elem_size)
+		{
+			return pos <= size && (elem_size == 0 || count <= (size - pos) / elem_size);
+		};
+		if (h.num_verts >= size ||
+			!fits(h.offsets_pos, h.num_verts + 1, sizeof(uint64_t)) ||
+			!fits(h.targets_pos, h.num_edges, sizeof(uint64_t)) ||
+			!fits(h.weights_pos, h.num_edges, sizeof(float)) ||
+			!fits(h.payloads_pos, h.num_verts, h.payload_size) ||
+			reinterpret_cast<const uint64_t*>(file.data() + h.offsets_pos)[h.num_verts] != h.num_edges)
+		{
+			throw std::runtime_error("Graph file is truncated");
+		}
+		if (check_contents)
+		{
+			const uint64_t* const offsets = reinterpret_cast<const uint64_t*>(file.data() + h.offsets_pos);
+			const uint64_t* const targets = reinterpret_cast<const uint64_t*>(file.data() + h.targets_pos);
+			if (offsets[0] != 0)
+			{
+				throw std::runtime_error("Graph file is corrupt");
+			}
+			for (uint64_t v = 0; v < h.num_verts; v++)
+			{
+				if (offsets[v] > offsets[v + 1])
+				{
+					throw std::runtime_error("Graph file is corrupt");
+				}
+			}
+			for (uint64_t k = 0; k < h.num_edges; k++)
+			{
+				if (targets[k] >= h.num_verts)
+				{
+					throw std::runtime_error("Graph file is corrupt");
+				}
+			}
+		}
+		return h;
+	}
+	// the csr arrays of a mapped file as a graph that keeps the mapping alive
+	static CsrGraph View(const std::shared_ptr<const MappedFile>& file, bool check_contents)
+	{
+		const GraphFileHeader& h = Validate(*file, check_contents);
+		const char* const base = file->data();
+		const size_t n = size_t(h.num_verts);
+		const float* const weights = reinterpret_cast<const float*>(base + h.weights_pos);
+#if SIZE_MAX == UINT64_MAX
+		return CsrGraph::View(n,
+			reinterpret_cast<const size_t*>(base + h.offsets_pos),
+			reinterpret_cast<const size_t*>(base + h.targets_pos),
+			weights, file);
+#else
+		// indices are narrower than in the file, they have to be copied
+		struct Narrowed
+		{
+			std::shared_ptr<const MappedFile> file;
+			DSA<size_t> offsets;
+			DSA<size_t> targets;
+		};
+		const auto narrowed = std::make_shared<Narrowed>();
+		const uint64_t* const offsets = reinterpret_cast<const uint64_t*>(base + h.offsets_pos);
+		const uint64_t* const targets = reinterpret_cast<const uint64_t*>(base + h.targets_pos);
+		narrowed->file = file;
+		narrowed->offsets = DSA<size_t>(n + 1);
+		narrowed->targets = DSA<size_t>(size_t(h.num_edges));
+		for (size_t i = 0; i <= n; i++)
+		{
+			narrowed->offsets[i] = size_t(offsets[i]);
+		}
+		for (size_t k = 0; k < size_t(h.num_edges); k++)
+		{
+			narrowed->targets[k] = size_t(targets[k]);
+		}
+		return CsrGraph::View(n, narrowed->offsets.data(), narrowed->targets.data(), weights, narrowed);
+#endif
+	}
+
+private:
+	static constexpr uint32_t Magic = 0x48505247; // "GRPH"
+	static constexpr uint32_t SwappedMagic = 0x47525048;
+	static constexpr uint32_t Version = 1;
+	// every array starts at a multiple of this many bytes
+	static constexpr uint64_t Align = 64;
+};
+
+// a mapped graph file along with its vertex payloads
+template <typename V>
+class MappedGraph
+{
+	static_assert(std::is_trivially_copyable<V>::value, "Vertex payloads must be trivially copyable");
+
+public:
+	// maps the file at given path, throws if it isn't a graph file
+	// or its payloads aren't the size of V, see GraphFile::Map
+	explicit MappedGraph(const std::string& path, bool check_contents = true)
+	{
+		const std::shared_ptr<const MappedFile> file = std::make_shared<MappedFile>(path);
+		graph = GraphFile::View(file, check_contents);
+		const GraphFileHeader& h = *reinterpret_cast<const GraphFileHeader*>(file->data());
+		if (h.payload_size != sizeof(V))
+		{
+			throw std::runtime_error("Graph file payloads are the wrong size");
+		}
+		payloads = reinterpret_cast<const V*>(file->data() + h.payloads_pos);
+	}
+
+	// the graph, copies of it keep the file mapped
+	const CsrGraph& GetGraph() const
+	{
+		return graph;
+	}
+	// num of vertices in the graph
+	size_t NumVertices() const
+	{
+		return graph.NumVertices();
+	}
+	// payload of the vertex at given idx
+	const V& GetPayload(size_t idx) const
+	{
+		assert(idx < graph.NumVertices() && "Vertex does not exist");
+		return payloads[idx];
+	}
+
+private:
+	CsrGraph graph;
+	// points into the file, which graph keeps mapped
+	const V* payloads = nullptr;
+};
@@ -0,0 +1,191 @@
+#pragma once
+#include <cstdint>
+#include "Graph.h"
+#include "GraphBuilder.h"
+#include "ThreadPool.h"
+
+// synthetic graphs of any size for load testing
+// every edge is made from the seed and its own position alone, so a seed
+// always gives the same graph whatever the num of threads generating it
+// each generator returns a builder holding the edges, to be turned into a
+// csr graph with BuildCsr or into a Graph<V> with FillGraph, which is also
+// where parallel edges and self loops can be merged and edges symmetrized
+// weights are drawn uniformly from [1, max_weight]
+
+// small fast random num generator, seeded with the hash of the seed and
+// the position of the edge being made (splitmix64)
+class EdgeRng
+{
+public:
+	EdgeRng(uint64_t seed, uint64_t pos)
+		:
+		state(Mix(seed ^ Mix(pos + 0x9e3779b97f4a7c15ull)))
+	{}
+
+	// a uniformly random 64 bit num
+	uint64_t Next()
+	{
+		state += 0x9e3779b97f4a7c15ull;
+		return Mix(state);
+	}
+	// a random num in [0, bound)
+	uint64_t Below(uint64_t bound)
+	{
+		return Next() % bound;
+	}
+	// a random num in [0, 1)
+	double Unit()
+	{
+		return double(Next() >> 11) * (1.0 / 9007199254740992.0);
+	}
+	// a random weight in [1, max_weight]
+	float Weight(float max_weight)
+	{
+		return max_weight > 1.0f ? float(1.0 + Unit() * (max_weight - 1.0)) : 1.0f;
+	}
+
+	static uint64_t Mix(uint64_t x)
+	{
+		x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+		x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+		return x ^ (x >> 31);
+	}
+
+private:
+	uint64_t state;
+};
+
+// the probabilities of an r-mat edge falling in each quarter of the
+// adjacency matrix at every level, d is whatever is left of 1
+struct RmatParams
+{
+	double a = 0.57;
+	double b = 0.19;
+	double c = 0.19;
+};
+
+// r-mat graph with 2^scale vertices and edge_factor * 2^scale edges
+// every edge picks a quarter of the adjacency matrix scale times over,
+// giving the skewed degrees and small world of social and web graphs
+// (the graph500 generator), vertex indices are scrambled so that the
+// high degree vertices aren't all at low indices
+inline GraphBuilder GenerateRmat(size_t scale, size_t edge_factor, uint64_t seed, ThreadPool& pool,
+	float max_weight = 1.0f, RmatParams params = RmatParams())
+{
+	assert(scale <= 32 && "Vertex idx does not fit in 32 bits");
+	const uint64_t mask = (uint64_t(1) << scale) - 1;
+	const unsigned half = unsigned(scale / 2);
+	// a bijection of [0, 2^scale), multiplying by an odd num and xoring in
+	// the high bits can both be undone
+	const auto scramble = [=](uint64_t v)
+	{
+		v = (v * 0x9e3779b97f4a7c15ull + seed) & mask;
+		v ^= v >> (half + 1);
+		return (v * 0xbf58476d1ce4e5b9ull) & mask;
+	};
+	// the chances as 32 bit thresholds, so one random num decides a level
+	const double ab = params.a + params.b;
+	const uint64_t bottom_at = uint64_t(ab * 4294967296.0);
+	const uint64_t top_right_at = uint64_t(params.a / ab * 4294967296.0);
+	const uint64_t bottom_right_at = uint64_t(params.c / (1.0 - ab) * 4294967296.0);
+
+	GraphBuilder builder(size_t(1) << scale);
+	builder.AddEdges(edge_factor << scale, pool, [&](size_t i)
+	{
+		EdgeRng rng(seed, i);
+		uint64_t src = 0, dst = 0;
+		for (size_t level = 0; level < scale; level++)
+		{
+			// top or bottom half, then left or right given the half
+			const uint64_t r = rng.Next();
+			const bool bottom = (r & 0xffffffff) >= bottom_at;
+			const bool right = (r >> 32) >= (bottom ? bottom_right_at : top_right_at);
+			src = (src << 1) | uint64_t(bottom);
+			dst = (dst << 1) | uint64_t(right);
+		}
+		return CsrGraph::Edge{ size_t(scramble(src)), size_t(scramble(dst)), rng.Weight(max_weight) };
+	});
+	return builder;
+}
+
+// erdos-renyi graph with num_verts vertices and num_edges edges, each
+// between two different vertices picked uniformly at random (the g(n, m)
+// model, parallel edges are possible until merged)
+inline GraphBuilder GenerateErdosRenyi(size_t num_verts, size_t num_edges, uint64_t seed, ThreadPool& pool,
+	float max_weight = 1.0f)
+{
+	assert(num_verts >= 2 && "A random edge needs two vertices");
+	GraphBuilder builder(num_verts);
+	builder.AddEdges(num_edges, pool, [&](size_t i)
+	{
+		EdgeRng rng(seed, i);
+		const size_t src = size_t(rng.Below(num_verts));
+		// any vertex but src
+		size_t dst = size_t(rng.Below(num_verts - 1));
+		dst += dst >= src;
+		return CsrGraph::Edge{ src, dst, rng.Weight(max_weight) };
+	});
+	return builder;
+}
+
+// rows by cols grid with every vertex joined to the ones to its right and
+// below, vertex (r, c) at idx r * cols + c, symmetrize for a road like mesh
+inline GraphBuilder GenerateGrid(size_t rows, size_t cols, uint64_t seed, ThreadPool& pool,
+	float max_weight = 1.0f)
+{
+	const size_t across = rows * (cols > 0 ? cols - 1 : 0);
+	const size_t down = (rows > 0 ? rows - 1 : 0) * cols;
+	GraphBuilder builder(rows * cols);
+	builder.AddEdges(across + down, pool, [&](size_t i)
+	{
+		EdgeRng rng(seed, i);
+		if (i < across)
+		{
+			const size_t r = i / (cols - 1);
+			const size_t src = r * cols + i % (cols - 1);
+			return CsrGraph::Edge{ src, src + 1, rng.Weight(max_weight) };
+		}
+		const size_t src = i - across;
+		return CsrGraph::Edge{ src, src + cols, rng.Weight(max_weight) };
+	});
+	return builder;
+}
+
+// barabasi-albert graph with num_verts vertices that each join
+// edges_per_vertex edges to the vertices before them, picked with
+// probability proportional to their degree, giving a power law
+// every edge end is a slot in one long array where edge k goes from slot
+// 2k, owned by vertex k / edges_per_vertex, to slot 2k + 1, which copies a
+// random earlier slot, picking a slot uniformly picks a vertex by degree,
+// so a slot is resolved by following the copies back to an even slot and
+// no edge has to wait for the ones before it (sanders and schulz)
+// the first edge is a self loop of vertex 0, as it has nothing before it
+inline GraphBuilder GenerateBarabasiAlbert(size_t num_verts, size_t edges_per_vertex, uint64_t seed, ThreadPool& pool,
+	float max_weight = 1.0f)
+{
+	GraphBuilder builder(num_verts);
+	builder.AddEdges(num_verts * edges_per_vertex, pool, [&](size_t k)
+	{
+		uint64_t slot = 2 * uint64_t(k) + 1;
+		while (slot % 2 == 1)
+		{
+			slot = EdgeRng(seed, slot).Below(slot);
+		}
+		return CsrGraph::Edge{ k / edges_per_vertex, size_t(slot / 2 / edges_per_vertex),
+			EdgeRng(seed, 2 * uint64_t(k)).Weight(max_weight) };
+	});
+	return builder;
+}
+
+// adds the vertices and edges of a generated graph to an empty g, with
+// value(idx) as the value of the vertex at idx
+template <typename V, typename F>
+void FillGraph(Graph<V>& g, const GraphBuilder& builder, ThreadPool& pool, F value)
+{
+	assert(g.GetVertices().size() == 0 && "Graph is not empty");
+	for (size_t i = 0; i < builder.NumVertices(); i++)
+	{
+		g.AddVertex(value(i));
+	}
+	builder.BuildInto(g, pool);
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <type_traits>
+#include "DSA.h"
+
+// distance estimates for A* search
+// a heuristic is called as h(idx, dst_idx) and returns a lower bound on the
+// length of the shortest path from the vertex at idx to the vertex at dst_idx
+
+// estimates every distance as 0, turning A* into dijkstra's algorithm
+struct ZeroHeuristic
+{
+	ZeroHeuristic() = default;
+	template <typename V>
+	explicit ZeroHeuristic(const DSA<V>&)
+	{}
+
+	float operator()(size_t, size_t) const
+	{
+		return 0.0f;
+	}
+};
+
+// estimates distances as the straight line distance between vertex positions
+// only admissible when no edge weight is less than the distance between its ends
+template <typename V>
+class PosHeuristic
+{
+public:
+	explicit PosHeuristic(const DSA<V>& verts)
+		:
+		verts(verts)
+	{}
+
+	float operator()(size_t idx, size_t dst_idx) const
+	{
+		return (verts[idx].GetPos() - verts[dst_idx].GetPos()).GetLength();
+	}
+
+private:
+	const DSA<V>& verts;
+};
+
+// true if V has a GetPos() member that can be used for distance estimates
+template <typename V, typename = void>
+struct HasGetPos : std::false_type
+{};
+template <typename V>
+struct HasGetPos<V, decltype((void)std::declval<const V&>().GetPos())> : std::true_type
+{};
+
+// heuristic used by Graph::AStar_idx when none is given
+// PosHeuristic for vertices with a position, ZeroHeuristic otherwise
+template <typename V>
+using DefaultHeuristic = typename std::conditional<HasGetPos<V>::value, PosHeuristic<V>, ZeroHeuristic>::type;
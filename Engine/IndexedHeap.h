@@ -0,0 +1,171 @@
+#pragma once
+#include "DSA.h"
+
+// d-ary min heap over the ids [0, n) where every id can be in the heap
+// at most once and its key can be lowered while it is in there
+// the position of every id in the heap is tracked so decrease() is O(log n)
+template <size_t D = 4>
+class IndexedHeap
+{
+	static_assert(D >= 2, "Heap arity must be at least 2");
+	static constexpr size_t NotInHeap = ~size_t(0);
+
+public:
+	// creates an empty heap that can hold ids less than n
+	IndexedHeap(size_t n)
+		:
+		ids(n),
+		keys(n),
+		// copied so the constant isn't bound to a reference, which would need
+		// an out of class definition before c++17
+		pos(n, size_t(NotInHeap))
+	{}
+
+	// adds id to the heap with given key
+	void push(size_t id, float key)
+	{
+		assert(!contains(id) && "Id already in heap");
+		keys[id] = key;
+		ids[count] = id;
+		pos[id] = count;
+		SiftUp(count++);
+	}
+	// lowers the key of an id already in the heap
+	void decrease(size_t id, float key)
+	{
+		assert(contains(id) && "Id not in heap");
+		assert(key <= keys[id] && "Key can only be decreased");
+		keys[id] = key;
+		SiftUp(pos[id]);
+	}
+	// changes the key of an id already in the heap in either direction
+	void update(size_t id, float key)
+	{
+		assert(contains(id) && "Id not in heap");
+		const float old = keys[id];
+		keys[id] = key;
+		if (key < old)
+			SiftUp(pos[id]);
+		else
+			SiftDown(pos[id]);
+	}
+	// removes every id, O(size) rather than O(n) so a heap can be reused
+	// cheaply between searches that only touch a few ids
+	void clear()
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			pos[ids[i]] = NotInHeap;
+		}
+		count = 0;
+	}
+	// id with the smallest key
+	size_t top() const
+	{
+		assert(!empty());
+		return ids[0];
+	}
+	// smallest key in the heap
+	float top_key() const
+	{
+		assert(!empty());
+		return keys[ids[0]];
+	}
+	// removes the id with the smallest key
+	void pop()
+	{
+		assert(!empty());
+		pos[ids[0]] = NotInHeap;
+		if (--count > 0)
+		{
+			ids[0] = ids[count];
+			pos[ids[0]] = 0;
+			SiftDown(0);
+		}
+	}
+
+	// true if id is currently in the heap
+	bool contains(size_t id) const
+	{
+		return pos[id] != NotInHeap;
+	}
+	// current key of an id in the heap
+	float key(size_t id) const
+	{
+		assert(contains(id));
+		return keys[id];
+	}
+	bool empty() const
+	{
+		return count == 0;
+	}
+	size_t size() const
+	{
+		return count;
+	}
+
+private:
+	// moves the id at heap slot i towards the root until its parent is smaller
+	void SiftUp(size_t i)
+	{
+		size_t* const h = ids.data();
+		const size_t id = h[i];
+		const float k = keys[id];
+		while (i > 0)
+		{
+			const size_t parent = (i - 1) / D;
+			if (!(k < keys[h[parent]]))
+			{
+				break;
+			}
+			h[i] = h[parent];
+			pos[h[i]] = i;
+			i = parent;
+		}
+		h[i] = id;
+		pos[id] = i;
+	}
+	// moves the id at heap slot i away from the root until its children are larger
+	void SiftDown(size_t i)
+	{
+		size_t* const h = ids.data();
+		const size_t id = h[i];
+		const float k = keys[id];
+		while (true)
+		{
+			const size_t first = i * D + 1;
+			if (first >= count)
+			{
+				break;
+			}
+			// find the smallest child
+			const size_t last = first + D < count ? first + D : count;
+			size_t best = first;
+			for (size_t c = first + 1; c < last; c++)
+			{
+				if (keys[h[c]] < keys[h[best]])
+				{
+					best = c;
+				}
+			}
+			if (!(keys[h[best]] < k))
+			{
+				break;
+			}
+			h[i] = h[best];
+			pos[h[i]] = i;
+			i = best;
+		}
+		h[i] = id;
+		pos[id] = i;
+	}
+
+private:
+	// heap ordered ids
+	DSA<size_t> ids;
+	// key of every id, indexed by id
+	DSA<float> keys;
+	// slot of every id in the heap, indexed by id
+	DSA<size_t> pos;
+	size_t count = 0;
+};
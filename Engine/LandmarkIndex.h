@@ -0,0 +1,250 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include "CsrGraph.h"
+#include "ThreadPool.h"
+
+// precomputed distances from and to a small set of landmark vertices
+// by the triangle inequality d(v, t) >= d(L, t) - d(L, v) and
+// d(v, t) >= d(v, L) - d(t, L) for every landmark L, which gives a lower
+// bound on any distance in O(num landmarks) (ALT)
+// an index can be passed straight to AStar_idx as its heuristic
+class LandmarkIndex
+{
+public:
+	// builds an index over g using num_landmarks landmarks
+	// landmarks are picked greedily as the vertex farthest (in hops) from the
+	// ones picked so far, the 2 * num_landmarks dijkstra searches that fill
+	// the tables are spread over the pool
+	// symmetric graphs (every edge has a reverse edge of the same weight)
+	// only need the searches from the landmarks
+	LandmarkIndex(const CsrGraph& g, size_t num_landmarks, ThreadPool& pool, bool symmetric = false)
+		:
+		num_verts(g.NumVertices()),
+		num_edges(g.NumEdges()),
+		symmetric(symmetric),
+		landmarks(PickLandmarks(g, std::min(num_landmarks, g.NumVertices()))),
+		from(num_verts * landmarks.size()),
+		to(symmetric ? 0 : num_verts * landmarks.size())
+	{
+		const size_t k = landmarks.size();
+		const CsrGraph rev = symmetric ? CsrGraph() : g.Transpose();
+		const size_t num_jobs = symmetric ? k : 2 * k;
+
+		pool.ParallelFor(num_jobs, 1, [&](size_t, size_t begin, size_t end)
+		{
+			for (size_t job = begin; job < end; job++)
+			{
+				// jobs [0, k) fill from, jobs [k, 2k) fill to using the
+				// reversed graph, where d(L, v) is d(v, L) in the original
+				const size_t l = job % k;
+				const bool forward = job < k;
+				const ShortestPathTree tree = (forward ? g : rev).DijkstraAll_idx(landmarks[l]);
+				float* const table = forward ? from.data() : to.data();
+				for (size_t v = 0; v < num_verts; v++)
+				{
+					table[v * k + l] = tree.dist[v];
+				}
+			}
+		});
+	}
+	// reads an index written by Save
+	// throws if the stream does not hold a valid index
+	static LandmarkIndex Load(std::istream& in)
+	{
+		LandmarkIndex res;
+		uint32_t magic = 0, version = 0;
+		uint64_t header[4] = {};
+		in.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+		in.read(reinterpret_cast<char*>(&version), sizeof(version));
+		in.read(reinterpret_cast<char*>(header), sizeof(header));
+		if (!in || magic != Magic || version != Version)
+		{
+			throw std::runtime_error("Not a landmark index");
+		}
+		// the sizes are checked before anything is allocated, the tables are
+		// read as they arrive so a corrupt size fails on the end of the stream
+		const uint64_t n = header[0];
+		const uint64_t k = header[2];
+		if (n > SIZE_MAX || header[1] > SIZE_MAX || k > n || (k > 0 && n > SIZE_MAX / k))
+		{
+			throw std::runtime_error("Corrupt landmark index");
+		}
+		res.num_verts = size_t(n);
+		res.num_edges = size_t(header[1]);
+		res.symmetric = header[3] != 0;
+
+		res.landmarks = DSA<size_t>(0);
+		for (uint64_t l = 0; l < k; l++)
+		{
+			uint64_t idx = 0;
+			in.read(reinterpret_cast<char*>(&idx), sizeof(idx));
+			if (!in)
+			{
+				throw std::runtime_error("Truncated landmark index");
+			}
+			if (idx >= n)
+			{
+				throw std::runtime_error("Corrupt landmark index");
+			}
+			res.landmarks.push_back(size_t(idx));
+		}
+		ReadFloats(in, res.num_verts * size_t(k), res.from);
+		ReadFloats(in, res.symmetric ? 0 : res.num_verts * size_t(k), res.to);
+		return res;
+	}
+	// writes the index in a binary form that Load can read back
+	void Save(std::ostream& out) const
+	{
+		const uint32_t magic = Magic, version = Version;
+		const uint64_t header[4] = { num_verts, num_edges, landmarks.size(), symmetric ? 1u : 0u };
+		out.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+		out.write(reinterpret_cast<const char*>(&version), sizeof(version));
+		out.write(reinterpret_cast<const char*>(header), sizeof(header));
+		for (auto l : landmarks)
+		{
+			const uint64_t idx = l;
+			out.write(reinterpret_cast<const char*>(&idx), sizeof(idx));
+		}
+		out.write(reinterpret_cast<const char*>(from.data()), from.size() * sizeof(float));
+		out.write(reinterpret_cast<const char*>(to.data()), to.size() * sizeof(float));
+	}
+
+	// true if the index was built for a graph of the same shape as g
+	// (a cheap guard against using an index with the wrong graph version)
+	bool Matches(const CsrGraph& g) const
+	{
+		return g.NumVertices() == num_verts && g.NumEdges() == num_edges;
+	}
+
+	// lower bound on the distance from the vertex at idx to the one at dst_idx
+	float LowerBound(size_t idx, size_t dst_idx) const
+	{
+		assert(idx < num_verts && dst_idx < num_verts && "Vertex does not exist");
+		const size_t k = landmarks.size();
+		const float* const f_v = from.data() + idx * k;
+		const float* const f_t = from.data() + dst_idx * k;
+		const float* const t_v = (symmetric ? from.data() : to.data()) + idx * k;
+		const float* const t_t = (symmetric ? from.data() : to.data()) + dst_idx * k;
+
+		float best = 0.0f;
+		for (size_t l = 0; l < k; l++)
+		{
+			// terms involving unreachable vertices give no bound
+			const float a = f_t[l] - f_v[l];
+			const float b = t_v[l] - t_t[l];
+			if (std::isfinite(a))
+			{
+				best = std::max(best, a);
+			}
+			if (std::isfinite(b))
+			{
+				best = std::max(best, b);
+			}
+		}
+		return best;
+	}
+	// upper bound on the distance from the vertex at idx to the one at dst_idx
+	// given by the shortest detour through a landmark, infinity if none connects them
+	float UpperBound(size_t idx, size_t dst_idx) const
+	{
+		assert(idx < num_verts && dst_idx < num_verts && "Vertex does not exist");
+		const size_t k = landmarks.size();
+		const float* const t_v = (symmetric ? from.data() : to.data()) + idx * k;
+		const float* const f_t = from.data() + dst_idx * k;
+
+		float best = std::numeric_limits<float>::infinity();
+		for (size_t l = 0; l < k; l++)
+		{
+			best = std::min(best, t_v[l] + f_t[l]);
+		}
+		return best;
+	}
+	// heuristic interface used by AStar_idx
+	float operator()(size_t idx, size_t dst_idx) const
+	{
+		return LowerBound(idx, dst_idx);
+	}
+
+	// the landmark vertices
+	const DSA<size_t>& GetLandmarks() const
+	{
+		return landmarks;
+	}
+
+private:
+	LandmarkIndex() = default;
+	// farthest point selection over hop counts, starting from the vertex
+	// farthest from vertex 0, unreachable vertices count as farthest
+	static DSA<size_t> PickLandmarks(const CsrGraph& g, size_t k)
+	{
+		const size_t n = g.NumVertices();
+		DSA<size_t> res(k);
+		if (k == 0)
+		{
+			return res;
+		}
+		// hop count from the closest landmark picked so far
+		DSA<size_t> closest = g.BFS_dist(0);
+		for (size_t l = 0; l < k; l++)
+		{
+			size_t far = 0;
+			for (size_t v = 1; v < n; v++)
+			{
+				if (closest[v] > closest[far])
+				{
+					far = v;
+				}
+			}
+			res[l] = far;
+			const DSA<size_t> d = g.BFS_dist(far);
+			for (size_t v = 0; v < n; v++)
+			{
+				closest[v] = (l == 0) ? d[v] : std::min(closest[v], d[v]);
+			}
+		}
+		return res;
+	}
+	// reads count floats into arr, which grows as they arrive
+	// throws if the stream ends first
+	static void ReadFloats(std::istream& in, size_t count, DSA<float>& arr)
+	{
+		arr = DSA<float>(0);
+		float chunk[4096];
+		for (size_t done = 0; done < count;)
+		{
+			const size_t num = std::min(count - done, sizeof(chunk) / sizeof(float));
+			in.read(reinterpret_cast<char*>(chunk), num * sizeof(float));
+			if (!in)
+			{
+				throw std::runtime_error("Truncated landmark index");
+			}
+			for (size_t i = 0; i < num; i++)
+			{
+				arr.push_back(chunk[i]);
+			}
+			done += num;
+		}
+	}
+
+private:
+	static constexpr uint32_t Magic = 0x4b4d444c; // "LDMK"
+	static constexpr uint32_t Version = 1;
+
+private:
+	// shape of the graph the index was built for
+	size_t num_verts = 0;
+	size_t num_edges = 0;
+	// true if to is left empty since it equals from
+	bool symmetric = false;
+	DSA<size_t> landmarks;
+	// from[v * k + l] = d(landmarks[l], v)
+	DSA<float> from;
+	// to[v * k + l] = d(v, landmarks[l])
+	DSA<float> to;
+};
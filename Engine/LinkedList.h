@@ -14,10 +14,6 @@ class SinglyLinkedList
 			:
 			data(data)
 		{}
-		~Node()
-		{
-			delete next;
-		}
 	};
 
 public:
@@ -111,12 +107,17 @@ public:
 	{
 		*this = rhs;
 	}
+	// dtor
+	~SinglyLinkedList()
+	{
+		clear();
+	}
 	// copy assignment
 	SinglyLinkedList& operator=(const SinglyLinkedList& rhs)
 	{
 		if (this != &rhs)
 		{
-			delete first;
+			clear();
 			for (auto& elem : rhs)
 			{
 				push_back(elem);
@@ -189,6 +190,51 @@ public:
 		temp->next = nullptr;
 		delete temp;
 	}
+	// delete every value for which pred returns true
+	// returns the num of values deleted
+	template <typename Pred>
+	size_t remove_if(Pred pred)
+	{
+		size_t removed = 0;
+		Node* prev = nullptr;
+		Node* ptr = first;
+		while (ptr != nullptr)
+		{
+			Node* const next = ptr->next;
+			if (pred(ptr->data))
+			{
+				if (prev == nullptr)
+					first = next;
+				else
+					prev->next = next;
+				if (ptr == tail)
+				{
+					tail = prev;
+				}
+				delete ptr;
+				removed++;
+			}
+			else
+			{
+				prev = ptr;
+			}
+			ptr = next;
+		}
+		return removed;
+	}
+	// delete all values
+	// nodes are freed one at a time, a long list would overflow the stack
+	// if each node deleted the next
+	void clear()
+	{
+		while (first != nullptr)
+		{
+			Node* const next = first->next;
+			delete first;
+			first = next;
+		}
+		tail = nullptr;
+	}
 	// first value
 	T& front()
 	{
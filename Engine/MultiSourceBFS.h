@@ -0,0 +1,221 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include "CsrGraph.h"
+
+// a single (src, dst) query of a batch
+struct BfsQuery
+{
+	size_t src_idx;
+	size_t dst_idx;
+};
+
+// answers a batch of (src, dst) queries with one shared bredth first search
+// every vertex carries a 64 bit mask with one bit per query, so a single
+// pass over an edge advances all the searches that have reached its source
+// batches of more than 64 queries are split into sweeps of 64
+class MultiSourceBFS
+{
+public:
+	// num of queries answered by a single sweep
+	static constexpr size_t MaxBatch = 64;
+
+public:
+	// prepares searches over g, which must outlive this object
+	// symmetric graphs (every edge has a reverse edge) can skip building
+	// the transposed graph used to recover paths
+	MultiSourceBFS(const CsrGraph& g, bool symmetric = false)
+		:
+		g(g),
+		rev(symmetric ? CsrGraph() : g.Transpose()),
+		in(symmetric ? g : rev)
+	{}
+	// in may refer to rev, which a copy or move would leave behind
+	MultiSourceBFS(const MultiSourceBFS&) = delete;
+	MultiSourceBFS& operator=(const MultiSourceBFS&) = delete;
+
+	// returns the hop count of every query, g.NumVertices() if dst is unreachable
+	DSA<size_t> Distances(const DSA<BfsQuery>& queries) const
+	{
+		DSA<size_t> res(queries.size());
+		for (size_t first = 0; first < queries.size(); first += MaxBatch)
+		{
+			const size_t count = std::min(MaxBatch, queries.size() - first);
+			Sweep(queries, first, count, res, nullptr);
+		}
+		return res;
+	}
+	// returns the shortest path of every query, empty if dst is unreachable
+	DSA<DSA<size_t>> Paths(const DSA<BfsQuery>& queries) const
+	{
+		DSA<DSA<size_t>> res(queries.size());
+		DSA<size_t> dist(queries.size());
+		for (size_t first = 0; first < queries.size(); first += MaxBatch)
+		{
+			const size_t count = std::min(MaxBatch, queries.size() - first);
+			LevelLog log;
+			Sweep(queries, first, count, dist, &log);
+			for (size_t i = 0; i < count; i++)
+			{
+				res[first + i] = TracePath(queries[first + i], dist[first + i], i, log);
+			}
+		}
+		return res;
+	}
+
+private:
+	// the vertices that gained bits at each level, along with those bits
+	// sorted by vertex within a level so a vertex can be looked up quickly
+	struct LevelLog
+	{
+		DSA<size_t> level_offsets = DSA<size_t>(1, 0);
+		DSA<size_t> verts;
+		DSA<uint64_t> masks;
+	};
+
+private:
+	// runs one bit parallel search for queries [first, first + count)
+	// and writes their distances into dist, optionally logging every level
+	void Sweep(const DSA<BfsQuery>& queries, size_t first, size_t count, DSA<size_t>& dist, LevelLog* log) const
+	{
+		const size_t n = g.NumVertices();
+		// bits of the searches that have reached each vertex
+		DSA<uint64_t> seen(n, 0);
+		// bits of the searches whose frontier holds each vertex
+		DSA<uint64_t> visit(n, 0);
+		DSA<uint64_t> visit_next(n, 0);
+		uint64_t* const s = seen.data();
+		uint64_t* vis = visit.data();
+		uint64_t* vis_next = visit_next.data();
+		// vertices with a non zero visit / visit_next mask
+		DSA<size_t> frontier(n);
+		DSA<size_t> frontier_next(n);
+		size_t frontier_size = 0;
+
+		uint64_t pending = 0;
+		for (size_t i = 0; i < count; i++)
+		{
+			const BfsQuery& q = queries[first + i];
+			assert(q.src_idx < n && "Vertex does not exist");
+			assert(q.dst_idx < n && "Vertex does not exist");
+			const uint64_t bit = uint64_t(1) << i;
+			if (vis[q.src_idx] == 0)
+			{
+				frontier[frontier_size++] = q.src_idx;
+			}
+			s[q.src_idx] |= bit;
+			vis[q.src_idx] |= bit;
+			dist[first + i] = n;
+			pending |= bit;
+		}
+		if (log != nullptr)
+		{
+			Record(*log, frontier, frontier_size, vis);
+		}
+		Resolve(queries, first, count, s, 0, pending, dist);
+
+		for (size_t level = 1; frontier_size > 0 && pending != 0; level++)
+		{
+			size_t next_size = 0;
+			for (size_t i = 0; i < frontier_size; i++)
+			{
+				const size_t cur = frontier[i];
+				const uint64_t bits = vis[cur];
+				vis[cur] = 0;
+				for (size_t k = g.EdgesBegin(cur); k < g.EdgesEnd(cur); k++)
+				{
+					const size_t nbr = g.Target(k);
+					const uint64_t fresh = bits & ~s[nbr];
+					if (fresh != 0)
+					{
+						if (vis_next[nbr] == 0)
+						{
+							frontier_next[next_size++] = nbr;
+						}
+						vis_next[nbr] |= fresh;
+					}
+				}
+			}
+			// the new bits only become visible once the whole level is done
+			for (size_t i = 0; i < next_size; i++)
+			{
+				const size_t v = frontier_next[i];
+				s[v] |= vis_next[v];
+			}
+			if (log != nullptr)
+			{
+				Record(*log, frontier_next, next_size, vis_next);
+			}
+
+			std::swap(frontier, frontier_next);
+			std::swap(vis, vis_next);
+			frontier_size = next_size;
+			Resolve(queries, first, count, s, level, pending, dist);
+		}
+	}
+	// sets the distance of every pending query whose dst has just been reached
+	static void Resolve(const DSA<BfsQuery>& queries, size_t first, size_t count,
+		const uint64_t* seen, size_t level, uint64_t& pending, DSA<size_t>& dist)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			const uint64_t bit = uint64_t(1) << i;
+			if ((pending & bit) && (seen[queries[first + i].dst_idx] & bit))
+			{
+				dist[first + i] = level;
+				pending &= ~bit;
+			}
+		}
+	}
+	// appends a level to the log, sorted by vertex
+	static void Record(LevelLog& log, DSA<size_t>& level_verts, size_t size, const uint64_t* masks)
+	{
+		std::sort(level_verts.data(), level_verts.data() + size);
+		for (size_t i = 0; i < size; i++)
+		{
+			log.verts.push_back(level_verts[i]);
+			log.masks.push_back(masks[level_verts[i]]);
+		}
+		log.level_offsets.push_back(log.verts.size());
+	}
+	// true if the search with given bit reached v at exactly the given level
+	static bool ReachedAt(const LevelLog& log, size_t level, size_t v, uint64_t bit)
+	{
+		const size_t* const begin = log.verts.data() + log.level_offsets[level];
+		const size_t* const end = log.verts.data() + log.level_offsets[level + 1];
+		const size_t* const it = std::lower_bound(begin, end, v);
+		return it != end && *it == v && (log.masks[it - log.verts.data()] & bit);
+	}
+	// walks back from dst picking at every step an in neighbour that the
+	// search reached one level earlier
+	DSA<size_t> TracePath(const BfsQuery& q, size_t dist, size_t query_bit, const LevelLog& log) const
+	{
+		if (dist == g.NumVertices())
+		{
+			return DSA<size_t>();
+		}
+		const uint64_t bit = uint64_t(1) << query_bit;
+		DSA<size_t> path(dist + 1);
+		path[dist] = q.dst_idx;
+		for (size_t level = dist; level > 0; level--)
+		{
+			const size_t cur = path[level];
+			for (size_t k = in.EdgesBegin(cur); k < in.EdgesEnd(cur); k++)
+			{
+				if (ReachedAt(log, level - 1, in.Target(k), bit))
+				{
+					path[level - 1] = in.Target(k);
+					break;
+				}
+			}
+		}
+		return path;
+	}
+
+private:
+	const CsrGraph& g;
+	// transpose of g, empty if g is symmetric
+	CsrGraph rev;
+	// the graph whose out edges are the in edges of g
+	const CsrGraph& in;
+};
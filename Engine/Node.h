@@ -1,6 +1,7 @@
 #pragma once
 #include "Vec2.h"
 #include "Font.h"
+#include "VertexHash.h"
 
 class Node
 {
@@ -30,3 +31,13 @@ private:
 	// used to draw the numbers representing a node
 	static const Font font;
 };
+
+// nodes are identified by their address so that is all that needs hashing
+template <>
+struct VertexHash<Node>
+{
+	size_t operator()(const Node& node) const
+	{
+		return node.GetAddress();
+	}
+};
@@ -0,0 +1,117 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include "CacheLineArray.h"
+#include "CsrGraph.h"
+#include "ShortestPath.h"
+#include "ThreadPool.h"
+
+// level synchronous bredth first search that splits every frontier
+// between the threads of a pool
+// vertices are claimed with a compare and swap on their parent so every
+// vertex is discovered by exactly one thread, which appends it to its own
+// next frontier buffer, the buffers are concatenated between levels
+class ParallelBFS
+{
+public:
+	// prepares a search over g, g and pool must outlive this object
+	ParallelBFS(const CsrGraph& g, ThreadPool& pool)
+		:
+		g(g),
+		pool(pool)
+	{}
+
+	// computes the hop count to and parent of every vertex reachable from src
+	BfsTree Run(size_t src_idx) const
+	{
+		const size_t n = g.NumVertices();
+		assert(src_idx < n && "Vertex does not exist");
+
+		const size_t num_threads = pool.size();
+		BfsTree tree(src_idx, n);
+		size_t* const dist = tree.dist.data();
+
+		std::unique_ptr<std::atomic<size_t>[]> parent(new std::atomic<size_t>[n]);
+		pool.ParallelFor(n, ChunkSize, [&](size_t, size_t begin, size_t end)
+		{
+			for (size_t v = begin; v < end; v++)
+			{
+				parent[v].store(n, std::memory_order_relaxed);
+			}
+		});
+
+		// current and next level, each vertex is in at most one level
+		DSA<size_t> frontier(n);
+		DSA<size_t> next(n);
+		size_t frontier_size = 0;
+		// vertices discovered by each thread in the current level, each on
+		// its own cache line since every discovery updates the buffer's size
+		CacheLineArray<DSA<size_t>> local(num_threads);
+		DSA<size_t> local_offsets(num_threads + 1);
+
+		parent[src_idx].store(src_idx, std::memory_order_relaxed);
+		dist[src_idx] = 0;
+		frontier[frontier_size++] = src_idx;
+
+		for (size_t level = 1; frontier_size > 0; level++)
+		{
+			const size_t* const cur_level = frontier.data();
+			pool.ParallelFor(frontier_size, FrontierGrain, [&](size_t thread_idx, size_t begin, size_t end)
+			{
+				DSA<size_t>& out = local[thread_idx];
+				for (size_t i = begin; i < end; i++)
+				{
+					const size_t cur = cur_level[i];
+					for (size_t k = g.EdgesBegin(cur); k < g.EdgesEnd(cur); k++)
+					{
+						const size_t nbr = g.Target(k);
+						// cheap read first so claimed vertices don't cost a CAS
+						size_t expected = n;
+						if (parent[nbr].load(std::memory_order_relaxed) == n &&
+							parent[nbr].compare_exchange_strong(expected, cur, std::memory_order_relaxed))
+						{
+							dist[nbr] = level;
+							out.push_back(nbr);
+						}
+					}
+				}
+			});
+
+			// concatenate the per thread buffers into the next level
+			local_offsets[0] = 0;
+			for (size_t t = 0; t < num_threads; t++)
+			{
+				local_offsets[t + 1] = local_offsets[t] + local[t].size();
+			}
+			size_t* const next_level = next.data();
+			pool.RunOnAll([&](size_t thread_idx)
+			{
+				DSA<size_t>& buf = local[thread_idx];
+				std::copy(buf.data(), buf.data() + buf.size(), next_level + local_offsets[thread_idx]);
+				buf.resize(0);
+			});
+
+			frontier_size = local_offsets[num_threads];
+			std::swap(frontier, next);
+		}
+
+		pool.ParallelFor(n, ChunkSize, [&](size_t, size_t begin, size_t end)
+		{
+			for (size_t v = begin; v < end; v++)
+			{
+				tree.parent.data()[v] = parent[v].load(std::memory_order_relaxed);
+			}
+		});
+		return tree;
+	}
+
+private:
+	// vertices per chunk for whole vertex array passes
+	static constexpr size_t ChunkSize = 4096;
+	// frontier vertices per chunk, small enough to balance skewed degrees
+	static constexpr size_t FrontierGrain = 256;
+
+private:
+	const CsrGraph& g;
+	ThreadPool& pool;
+};
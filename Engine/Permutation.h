@@ -0,0 +1,49 @@
+#pragma once
+#include <utility>
+#include "DSA.h"
+
+// a relabeling of the indices 0 .. size() - 1, stored both ways
+struct Permutation
+{
+	// new idx of every old idx
+	DSA<size_t> old_to_new;
+	// old idx of every new idx
+	DSA<size_t> new_to_old;
+
+	// ctor, the empty permutation
+	Permutation() = default;
+	// builds a permutation from the old idx of every new idx
+	explicit Permutation(DSA<size_t> order)
+		:
+		old_to_new(order.size()),
+		new_to_old(std::move(order))
+	{
+		for (size_t i = 0; i < new_to_old.size(); i++)
+		{
+			assert(new_to_old[i] < new_to_old.size() && "Not a permutation");
+			old_to_new[new_to_old[i]] = i;
+		}
+	}
+
+	// num of indices
+	size_t size() const
+	{
+		return new_to_old.size();
+	}
+	// the permutation that undoes this one
+	Permutation Inverse() const
+	{
+		return Permutation(old_to_new);
+	}
+	// the permutation that applies this one and then next
+	Permutation Then(const Permutation& next) const
+	{
+		assert(next.size() == size());
+		DSA<size_t> order(size());
+		for (size_t i = 0; i < size(); i++)
+		{
+			order[i] = new_to_old[next.new_to_old[i]];
+		}
+		return Permutation(std::move(order));
+	}
+};
@@ -0,0 +1,279 @@
+#pragma once
+#include <cstdint>
+#include <random>
+#include "Condensation.h"
+
+// answers "is there a directed path from src to dst" without a search
+// built over the condensation dag of a graph, vertices in the same strongly
+// connected component reach each other and the topological order of the
+// components rules out every path that would have to go backwards
+// dags with few components get the full transitive closure as one bit per
+// pair, larger ones get grail style interval labels that settle most
+// queries on their own and guide a pruned dfs for the rest
+class ReachabilityIndex
+{
+public:
+	// ctor, holds no vertices
+	ReachabilityIndex() = default;
+	// indexes g, num_labels is the num of interval labels per component
+	// used if the dag is too big for the closure, more labels rule out
+	// more pairs at the cost of memory
+	template <typename V>
+	explicit ReachabilityIndex(const Graph<V>& g, size_t num_labels = DefaultLabels, uint32_t seed = 0)
+		:
+		ReachabilityIndex(CsrGraph(g), num_labels, seed)
+	{}
+	// indexes g, num_labels is the num of interval labels per component
+	// used if the dag is too big for the closure, more labels rule out
+	// more pairs at the cost of memory
+	explicit ReachabilityIndex(const CsrGraph& g, size_t num_labels = DefaultLabels, uint32_t seed = 0)
+		:
+		scc(g)
+	{
+		if (scc.NumComponents() <= MaxClosureComponents)
+		{
+			BuildClosure();
+		}
+		else
+		{
+			assert(num_labels > 0);
+			BuildLabels(num_labels, seed);
+		}
+	}
+
+	// true if there is a directed path from the src idx to the dst idx
+	bool CanReach(size_t src_idx, size_t dst_idx) const
+	{
+		const size_t from = scc.Component(src_idx);
+		const size_t to = scc.Component(dst_idx);
+		if (from == to)
+		{
+			return true;
+		}
+		if (from > to)
+		{
+			return false;
+		}
+		if (UsesClosure())
+		{
+			return (closure.data()[from * row_words + (to >> 6)] >> (to & 63)) & 1;
+		}
+		if (!MayReach(from, to))
+		{
+			return false;
+		}
+		if (IsTreeDescendant(from, to))
+		{
+			return true;
+		}
+		return GuidedSearch(from, to);
+	}
+
+	// true if the index stores the full transitive closure
+	bool UsesClosure() const
+	{
+		return row_words > 0;
+	}
+	// the components and condensation dag the index is built on
+	const Condensation& GetCondensation() const
+	{
+		return scc;
+	}
+
+private:
+	// a [low, high] range of post order ranks, every component reachable
+	// from the labelled one has its own range inside this one
+	struct Interval
+	{
+		uint32_t low;
+		uint32_t high;
+	};
+
+private:
+	// closure row of every component, computed in reverse topological order
+	// so the rows of all its successors are already complete
+	void BuildClosure()
+	{
+		const size_t num_comps = scc.NumComponents();
+		const CsrGraph& dag = scc.Dag();
+		row_words = (num_comps + 63) / 64;
+		closure = DSA<uint64_t>(num_comps * row_words, 0);
+		uint64_t* const rows = closure.data();
+
+		for (size_t c = num_comps; c-- > 0;)
+		{
+			uint64_t* const row = rows + c * row_words;
+			row[c >> 6] |= uint64_t(1) << (c & 63);
+			for (size_t k = dag.EdgesBegin(c); k < dag.EdgesEnd(c); k++)
+			{
+				// successors come later in topological order so the words
+				// before the successor's own are all zero
+				const size_t d = dag.Target(k);
+				const uint64_t* const succ_row = rows + d * row_words;
+				for (size_t w = d >> 6; w < row_words; w++)
+				{
+					row[w] |= succ_row[w];
+				}
+			}
+		}
+	}
+	// num_labels randomized dfs traversals of the dag, each assigns post order
+	// ranks and labels every component with the smallest rank it can reach
+	// the first traversal also records the range of its own dfs subtree
+	void BuildLabels(size_t num_labels, uint32_t seed)
+	{
+		const size_t num_comps = scc.NumComponents();
+		assert(num_comps < UINT32_MAX && "Too many components");
+		const CsrGraph& dag = scc.Dag();
+		labels_per_comp = num_labels;
+		labels = DSA<Interval>(num_comps * num_labels);
+		tree_low = DSA<uint32_t>(num_comps);
+
+		std::mt19937 rng(seed);
+		// components without incoming dag edges, every dfs starts at one of them
+		DSA<size_t> roots;
+		{
+			Bitset has_pred(num_comps);
+			for (size_t k = 0; k < dag.NumEdges(); k++)
+			{
+				has_pred.set(dag.Target(k));
+			}
+			for (size_t c = 0; c < num_comps; c++)
+			{
+				if (!has_pred.test(c))
+				{
+					roots.push_back(c);
+				}
+			}
+		}
+
+		Bitset visited(num_comps);
+		DSA<size_t> path(num_comps);
+		// offset of the next child to follow and the num followed so far
+		DSA<size_t> next(num_comps);
+		DSA<size_t> done(num_comps);
+		for (size_t l = 0; l < num_labels; l++)
+		{
+			Interval* const lab = labels.data() + l;
+			std::shuffle(roots.data(), roots.data() + roots.size(), rng);
+			visited.clear();
+			uint32_t rank = 0;
+
+			for (size_t r = 0; r < roots.size(); r++)
+			{
+				size_t depth = 0;
+				const auto push = [&](size_t c)
+				{
+					visited.set(c);
+					path[depth] = c;
+					// starting each child list at a random position gives every
+					// traversal a different order
+					next[depth] = dag.Degree(c) > 0 ? rng() % dag.Degree(c) : 0;
+					done[depth] = 0;
+					depth++;
+					if (l == 0)
+					{
+						tree_low[c] = rank;
+					}
+				};
+				push(roots[r]);
+				while (depth > 0)
+				{
+					const size_t c = path[depth - 1];
+					const size_t deg = dag.Degree(c);
+					if (done[depth - 1] < deg)
+					{
+						size_t& i = next[depth - 1];
+						const size_t d = dag.Target(dag.EdgesBegin(c) + i);
+						i = i + 1 < deg ? i + 1 : 0;
+						done[depth - 1]++;
+						if (!visited.test(d))
+						{
+							push(d);
+						}
+						continue;
+					}
+					depth--;
+					lab[c * num_labels].high = rank++;
+				}
+			}
+
+			// every successor comes later in topological order so a reverse
+			// sweep sees the lows of all of them before they are needed
+			for (size_t c = num_comps; c-- > 0;)
+			{
+				uint32_t low = lab[c * num_labels].high;
+				for (size_t k = dag.EdgesBegin(c); k < dag.EdgesEnd(c); k++)
+				{
+					low = std::min(low, lab[dag.Target(k) * num_labels].low);
+				}
+				lab[c * num_labels].low = low;
+			}
+		}
+	}
+	// false if some label proves there is no path between the components
+	bool MayReach(size_t from, size_t to) const
+	{
+		const Interval* const a = labels.data() + from * labels_per_comp;
+		const Interval* const b = labels.data() + to * labels_per_comp;
+		for (size_t l = 0; l < labels_per_comp; l++)
+		{
+			if (b[l].low < a[l].low || b[l].high > a[l].high)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+	// true if to is under from in the dfs tree of the first traversal
+	// whose subtrees cover contiguous ranges of post order ranks
+	bool IsTreeDescendant(size_t from, size_t to) const
+	{
+		const uint32_t to_rank = labels.data()[to * labels_per_comp].high;
+		return tree_low.data()[from] <= to_rank && to_rank <= labels.data()[from * labels_per_comp].high;
+	}
+	// dfs over the dag that only enters components that could still reach to
+	bool GuidedSearch(size_t from, size_t to) const
+	{
+		const CsrGraph& dag = scc.Dag();
+		Bitset visited(scc.NumComponents());
+		DSA<size_t> s(scc.NumComponents());
+		size_t depth = 0;
+		visited.set(from);
+		s[depth++] = from;
+		while (depth > 0)
+		{
+			const size_t c = s[--depth];
+			for (size_t k = dag.EdgesBegin(c); k < dag.EdgesEnd(c); k++)
+			{
+				const size_t d = dag.Target(k);
+				if (d == to || (d < to && IsTreeDescendant(d, to)))
+				{
+					return true;
+				}
+				if (d < to && !visited.test_and_set(d) && MayReach(d, to))
+				{
+					s[depth++] = d;
+				}
+			}
+		}
+		return false;
+	}
+
+private:
+	// the largest dag that gets the transitive closure, takes 2 MiB
+	static constexpr size_t MaxClosureComponents = 4096;
+	static constexpr size_t DefaultLabels = 3;
+
+private:
+	Condensation scc;
+	// words per closure row, 0 if the labels are used instead
+	size_t row_words = 0;
+	// bit d of row c is set if component c reaches component d
+	DSA<uint64_t> closure;
+	// labels[c * labels_per_comp + l] is the label of component c in traversal l
+	size_t labels_per_comp = 0;
+	DSA<Interval> labels;
+	// smallest post order rank in each component's subtree of the first traversal
+	DSA<uint32_t> tree_low;
+};
@@ -0,0 +1,106 @@
+#pragma once
+#include <limits>
+#include "DSA.h"
+
+// walks a predecessor array back from dst to src
+// and returns the vertices in order from src to dst
+inline DSA<size_t> BuildPath(const DSA<size_t>& pred, size_t src_idx, size_t dst_idx)
+{
+	size_t len = 1;
+	for (size_t v = dst_idx; v != src_idx; v = pred[v])
+	{
+		len++;
+	}
+
+	DSA<size_t> path(len);
+	for (size_t v = dst_idx; len > 0; v = pred[v])
+	{
+		path[--len] = v;
+	}
+	return path;
+}
+
+// a path through a weighted graph along with its total weight
+struct WeightedPath
+{
+	// vertex indices from src to dst, empty if dst is unreachable
+	DSA<size_t> path;
+	// sum of the weights along the path, infinity if dst is unreachable
+	float distance = std::numeric_limits<float>::infinity();
+};
+
+// the result of a single source shortest path search
+// holds the distance to and the predecessor of every vertex
+struct ShortestPathTree
+{
+	// creates a tree over n vertices where nothing is reachable yet
+	ShortestPathTree(size_t src_idx, size_t n)
+		:
+		src_idx(src_idx),
+		dist(n, std::numeric_limits<float>::infinity()),
+		pred(n, n)
+	{}
+
+	// true if there is a path from src to the vertex at given idx
+	bool Reaches(size_t idx) const
+	{
+		return pred[idx] != pred.size();
+	}
+	// shortest path from src to the vertex at given idx
+	WeightedPath PathTo(size_t idx) const
+	{
+		WeightedPath res;
+		if (!Reaches(idx))
+		{
+			return res;
+		}
+		res.path = BuildPath(pred, src_idx, idx);
+		res.distance = dist[idx];
+		return res;
+	}
+
+	// the vertex the search started from
+	size_t src_idx;
+	// distance from src to every vertex, infinity if unreachable
+	DSA<float> dist;
+	// the vertex before each vertex on its shortest path
+	// pred[src] == src, pred[v] == n if v is unreachable
+	DSA<size_t> pred;
+};
+
+// the result of a single source bredth first search
+// holds the hop count to and the parent of every vertex
+struct BfsTree
+{
+	// creates a tree over n vertices where nothing is reachable yet
+	BfsTree(size_t src_idx, size_t n)
+		:
+		src_idx(src_idx),
+		dist(n, n),
+		parent(n, n)
+	{}
+
+	// true if there is a path from src to the vertex at given idx
+	bool Reaches(size_t idx) const
+	{
+		return parent[idx] != parent.size();
+	}
+	// shortest path from src to the vertex at given idx
+	// empty if the vertex is unreachable
+	DSA<size_t> PathTo(size_t idx) const
+	{
+		if (!Reaches(idx))
+		{
+			return DSA<size_t>();
+		}
+		return BuildPath(parent, src_idx, idx);
+	}
+
+	// the vertex the search started from
+	size_t src_idx;
+	// num of edges from src to every vertex, n if unreachable
+	DSA<size_t> dist;
+	// the vertex each vertex was discovered from
+	// parent[src] == src, parent[v] == n if v is unreachable
+	DSA<size_t> parent;
+};
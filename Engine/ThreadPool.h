@@ -0,0 +1,136 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "DSA.h"
+
+// fixed set of worker threads that all run the same task together
+// the calling thread takes part as thread 0, so a pool of size 1 starts no threads
+class ThreadPool
+{
+public:
+	// creates a pool of num_threads threads (including the caller)
+	// 0 uses one thread per hardware thread
+	explicit ThreadPool(size_t num_threads = 0)
+		:
+		num_threads(num_threads > 0 ? num_threads : DefaultSize()),
+		workers(this->num_threads - 1)
+	{
+		for (size_t i = 0; i < workers.size(); i++)
+		{
+			workers[i] = std::thread(&ThreadPool::WorkerLoop, this, i + 1);
+		}
+	}
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+	~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			quit = true;
+			generation++;
+		}
+		start_cv.notify_all();
+		for (auto& w : workers)
+		{
+			w.join();
+		}
+	}
+
+	// num of threads that run each task
+	size_t size() const
+	{
+		return num_threads;
+	}
+
+	// runs task(thread_idx) once on every thread of the pool
+	// and returns once all of them have finished
+	void RunOnAll(const std::function<void(size_t)>& task)
+	{
+		if (workers.size() == 0)
+		{
+			task(0);
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			cur_task = &task;
+			pending = workers.size();
+			generation++;
+		}
+		start_cv.notify_all();
+		task(0);
+
+		std::unique_lock<std::mutex> lock(mtx);
+		done_cv.wait(lock, [this] { return pending == 0; });
+		cur_task = nullptr;
+	}
+	// splits [0, count) into chunks of grain items that the threads take turns
+	// grabbing, calls body(thread_idx, begin, end) for every chunk
+	template <typename F>
+	void ParallelFor(size_t count, size_t grain, const F& body)
+	{
+		std::atomic<size_t> next(0);
+		RunOnAll([&](size_t thread_idx)
+		{
+			while (true)
+			{
+				const size_t begin = next.fetch_add(grain, std::memory_order_relaxed);
+				if (begin >= count)
+				{
+					break;
+				}
+				const size_t end = begin + grain < count ? begin + grain : count;
+				body(thread_idx, begin, end);
+			}
+		});
+	}
+
+private:
+	static size_t DefaultSize()
+	{
+		const size_t hw = std::thread::hardware_concurrency();
+		return hw > 0 ? hw : 1;
+	}
+	void WorkerLoop(size_t thread_idx)
+	{
+		size_t seen = 0;
+		while (true)
+		{
+			const std::function<void(size_t)>* task;
+			{
+				std::unique_lock<std::mutex> lock(mtx);
+				start_cv.wait(lock, [&] { return generation != seen; });
+				seen = generation;
+				if (quit)
+				{
+					return;
+				}
+				task = cur_task;
+			}
+
+			(*task)(thread_idx);
+
+			std::lock_guard<std::mutex> lock(mtx);
+			if (--pending == 0)
+			{
+				done_cv.notify_one();
+			}
+		}
+	}
+
+private:
+	size_t num_threads;
+	DSA<std::thread> workers;
+	std::mutex mtx;
+	std::condition_variable start_cv;
+	std::condition_variable done_cv;
+	// the task being run and how many workers have yet to finish it
+	const std::function<void(size_t)>* cur_task = nullptr;
+	size_t pending = 0;
+	// bumped for every task so workers can tell a new one was posted
+	size_t generation = 0;
+	bool quit = false;
+};
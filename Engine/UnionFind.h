@@ -0,0 +1,107 @@
+#pragma once
+#include <cstdint>
+#include <utility>
+#include "DSA.h"
+
+// disjoint sets of the indices 0 .. size() - 1
+// uses union by rank and path halving so every operation is
+// effectively constant time
+class UnionFind
+{
+public:
+	// ctor
+	UnionFind() = default;
+	// creates size singleton sets
+	explicit UnionFind(size_t size)
+		:
+		parent(size),
+		rank(size, 0),
+		num_sets(size)
+	{
+		for (size_t i = 0; i < size; i++)
+		{
+			parent[i] = i;
+		}
+	}
+
+	// adds a new singleton set and returns its element
+	size_t AddElement()
+	{
+		const size_t idx = parent.size();
+		parent.push_back(idx);
+		rank.push_back(0);
+		num_sets++;
+		return idx;
+	}
+	// returns the representative of the set containing x
+	// shortening the path to it on the way
+	size_t Find(size_t x)
+	{
+		size_t* const p = parent.data();
+		assert(x < parent.size());
+		while (p[x] != x)
+		{
+			p[x] = p[p[x]];
+			x = p[x];
+		}
+		return x;
+	}
+	// returns the representative of the set containing x
+	// without modifying the structure, safe to call from many threads at once
+	size_t Root(size_t x) const
+	{
+		const size_t* const p = parent.data();
+		assert(x < parent.size());
+		while (p[x] != x)
+		{
+			x = p[x];
+		}
+		return x;
+	}
+	// merges the sets containing a and b
+	// returns false if they were already the same set
+	bool Union(size_t a, size_t b)
+	{
+		a = Find(a);
+		b = Find(b);
+		if (a == b)
+		{
+			return false;
+		}
+		// the shallower tree goes under the deeper one
+		if (rank[a] < rank[b])
+		{
+			std::swap(a, b);
+		}
+		parent[b] = a;
+		if (rank[a] == rank[b])
+		{
+			rank[a]++;
+		}
+		num_sets--;
+		return true;
+	}
+	// true if a and b are in the same set
+	bool Connected(size_t a, size_t b) const
+	{
+		return Root(a) == Root(b);
+	}
+
+	// num of elements
+	size_t size() const
+	{
+		return parent.size();
+	}
+	// num of disjoint sets
+	size_t NumSets() const
+	{
+		return num_sets;
+	}
+
+private:
+	DSA<size_t> parent;
+	// upper bound on the height of the tree under each root
+	// at most log2 of the num of elements so a byte is plenty
+	DSA<uint8_t> rank;
+	size_t num_sets = 0;
+};
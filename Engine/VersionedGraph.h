@@ -0,0 +1,190 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include "CacheLineArray.h"
+#include "CsrGraph.h"
+
+// a sequence of immutable csr snapshots of a graph that is being updated
+// readers grab the latest snapshot without ever waiting on a writer and can
+// keep using it for as long as they hold it, writers build the next version
+// on the side and publish it with a single pointer swap
+// old versions are freed once no reader can still be looking at them,
+// tracked with epochs: every reader announces the epoch it started in and
+// a version retired in epoch e is only freed once all announcements are later
+class VersionedGraph
+{
+	// a published snapshot and its version num
+	struct Version
+	{
+		CsrGraph graph;
+		size_t num;
+	};
+	// a replaced snapshot waiting for its readers to finish
+	struct Retired
+	{
+		Version* version;
+		size_t epoch;
+	};
+	static constexpr size_t Idle = ~size_t(0);
+
+public:
+	// a pinned snapshot, the graph it points to stays alive until this is
+	// destroyed, a reader must not hold two of them at once
+	class Snapshot
+	{
+		friend class VersionedGraph;
+	private:
+		Snapshot(const Version* version, std::atomic<size_t>* slot)
+			:
+			version(version),
+			slot(slot)
+		{}
+	public:
+		Snapshot(const Snapshot&) = delete;
+		Snapshot& operator=(const Snapshot&) = delete;
+		Snapshot(Snapshot&& rhs)
+			:
+			version(rhs.version),
+			slot(rhs.slot)
+		{
+			rhs.slot = nullptr;
+		}
+		~Snapshot()
+		{
+			if (slot != nullptr)
+			{
+				slot->store(Idle, std::memory_order_release);
+			}
+		}
+
+		// the frozen graph
+		const CsrGraph& Get() const
+		{
+			return version->graph;
+		}
+		const CsrGraph* operator->() const
+		{
+			return &version->graph;
+		}
+		// num of the published version this is, the first is 0
+		size_t VersionNum() const
+		{
+			return version->num;
+		}
+
+	private:
+		const Version* version;
+		std::atomic<size_t>* slot;
+	};
+
+public:
+	// starts with initial as version 0, max_readers is the num of threads
+	// that may read at the same time, each with its own reader idx
+	explicit VersionedGraph(CsrGraph initial, size_t max_readers = 64)
+		:
+		readers(max_readers),
+		max_readers(max_readers),
+		current(new Version{ std::move(initial), 0 })
+	{
+		for (size_t i = 0; i < max_readers; i++)
+		{
+			readers[i].store(Idle, std::memory_order_relaxed);
+		}
+	}
+	VersionedGraph(const VersionedGraph&) = delete;
+	VersionedGraph& operator=(const VersionedGraph&) = delete;
+	// no reader may be holding a snapshot by now
+	~VersionedGraph()
+	{
+		delete current.load();
+		for (auto& r : retired)
+		{
+			delete r.version;
+		}
+	}
+
+	// pins and returns the latest snapshot for the reader at given idx
+	// never blocks, reader_idx is usually the thread idx of a ThreadPool
+	Snapshot Read(size_t reader_idx) const
+	{
+		assert(reader_idx < max_readers && "Reader does not exist");
+		std::atomic<size_t>& slot = readers[reader_idx];
+		assert(slot.load(std::memory_order_relaxed) == Idle && "Reader already holds a snapshot");
+		// the announcement has to be visible before the pointer is read,
+		// otherwise a writer could miss it and free what gets loaded
+		slot.store(epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+		return Snapshot(current.load(std::memory_order_seq_cst), &slot);
+	}
+	// num of the latest published version
+	size_t LatestVersion() const
+	{
+		return current.load(std::memory_order_acquire)->num;
+	}
+
+	// makes next the latest snapshot, readers that already hold the
+	// previous one keep it, returns the num of the new version
+	size_t Publish(CsrGraph next)
+	{
+		std::lock_guard<std::mutex> lock(writer_mtx);
+		Version* const fresh = new Version{ std::move(next), current.load(std::memory_order_relaxed)->num + 1 };
+		Version* const old = current.exchange(fresh, std::memory_order_seq_cst);
+		// readers announcing an epoch after this one started after the
+		// swap and can only have loaded fresh
+		retired.push_back({ old, epoch.fetch_add(1, std::memory_order_seq_cst) });
+		ReclaimLocked();
+		return fresh->num;
+	}
+	// snapshots g and publishes it
+	template <typename V>
+	size_t Publish(const Graph<V>& g)
+	{
+		return Publish(CsrGraph(g));
+	}
+	// frees every retired version no reader can still hold
+	// returns the num still waiting on readers
+	size_t Reclaim()
+	{
+		std::lock_guard<std::mutex> lock(writer_mtx);
+		return ReclaimLocked();
+	}
+
+private:
+	size_t ReclaimLocked()
+	{
+		size_t oldest = Idle;
+		for (size_t i = 0; i < max_readers; i++)
+		{
+			oldest = std::min(oldest, readers[i].load(std::memory_order_seq_cst));
+		}
+		size_t kept = 0;
+		for (size_t i = 0; i < retired.size(); i++)
+		{
+			// a reader that announced epoch e may have loaded any version
+			// retired in epoch e or later
+			if (retired[i].epoch < oldest)
+			{
+				delete retired[i].version;
+			}
+			else
+			{
+				retired[kept++] = retired[i];
+			}
+		}
+		retired.resize(kept);
+		return kept;
+	}
+
+private:
+	// the epoch every reader is in, each on its own cache line so readers
+	// announcing at the same time don't slow each other down
+	// mutable as reading only announces an epoch, the graph isn't changed
+	mutable CacheLineArray<std::atomic<size_t>> readers;
+	size_t max_readers;
+	std::atomic<Version*> current;
+	// incremented on every publish
+	std::atomic<size_t> epoch{ 0 };
+	// only touched by writers, under writer_mtx
+	std::mutex writer_mtx;
+	DSA<Retired> retired;
+};
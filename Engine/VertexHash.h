@@ -0,0 +1,153 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include "DSA.h"
+
+// hash used to look vertices up by value
+// specialize this for vertex types that std::hash does not support
+// or that have a cheaper key to hash (see Node.h)
+template <typename V>
+struct VertexHash
+{
+	size_t operator()(const V& val) const
+	{
+		return std::hash<V>()(val);
+	}
+};
+
+// open addressing (linear probing) hash table mapping vertex values to
+// their index in the graph's vertex array
+// only the index and the hash are stored per slot, the value itself is
+// compared against the vertex array passed in on lookup
+template <typename V>
+class VertexIndex
+{
+	// a slot in the table, empty when idx == Empty
+	struct Slot
+	{
+		size_t hash;
+		size_t idx;
+	};
+	static constexpr size_t Empty = ~size_t(0);
+
+public:
+	// ctor
+	VertexIndex()
+		:
+		slots(MinCapacity, Slot{ 0, Empty })
+	{}
+
+	// returns the index of val in verts or verts.size() if it isn't there
+	size_t Find(const V& val, const DSA<V>& verts) const
+	{
+		const size_t h = Hash(val);
+		const size_t mask = slots.size() - 1;
+		const Slot* const s = slots.data();
+		for (size_t i = h & mask; s[i].idx != Empty; i = (i + 1) & mask)
+		{
+			if (s[i].hash == h && verts[s[i].idx] == val)
+			{
+				return s[i].idx;
+			}
+		}
+		return verts.size();
+	}
+	// maps val to idx, val must not already be in the table
+	void Insert(const V& val, size_t idx)
+	{
+		// keep the load factor at or below 1/2 so probe chains stay short
+		if ((count + 1) * 2 > slots.size())
+		{
+			Grow();
+		}
+		Place(Hash(val), idx);
+		count++;
+	}
+	// removes the mapping of val, returns false if val isn't in the table
+	bool Erase(const V& val, const DSA<V>& verts)
+	{
+		const size_t h = Hash(val);
+		const size_t mask = slots.size() - 1;
+		Slot* const s = slots.data();
+		size_t i = h & mask;
+		while (s[i].idx != Empty && !(s[i].hash == h && verts[s[i].idx] == val))
+		{
+			i = (i + 1) & mask;
+		}
+		if (s[i].idx == Empty)
+		{
+			return false;
+		}
+
+		// later entries of the cluster whose probe chain runs through the
+		// freed slot are moved back into it so no chain is broken
+		for (size_t j = (i + 1) & mask; s[j].idx != Empty; j = (j + 1) & mask)
+		{
+			// distance of the hole and of slot j from where j's entry wants to be
+			const size_t home = s[j].hash & mask;
+			if (((i - home) & mask) < ((j - home) & mask))
+			{
+				s[i] = s[j];
+				i = j;
+			}
+		}
+		s[i].idx = Empty;
+		count--;
+		return true;
+	}
+	// removes all mappings
+	void clear()
+	{
+		slots = DSA<Slot>(MinCapacity, Slot{ 0, Empty });
+		count = 0;
+	}
+	// num of values in the table
+	size_t size() const
+	{
+		return count;
+	}
+
+private:
+	// scrambles the user hash so sequential keys don't form long clusters
+	static size_t Hash(const V& val)
+	{
+		uint64_t x = uint64_t(VertexHash<V>()(val));
+		x ^= x >> 33;
+		x *= 0xff51afd7ed558ccdULL;
+		x ^= x >> 33;
+		x *= 0xc4ceb9fe1a85ec53ULL;
+		x ^= x >> 33;
+		return size_t(x);
+	}
+	// writes an entry into the first free slot of its probe chain
+	void Place(size_t h, size_t idx)
+	{
+		const size_t mask = slots.size() - 1;
+		Slot* const s = slots.data();
+		size_t i = h & mask;
+		while (s[i].idx != Empty)
+		{
+			i = (i + 1) & mask;
+		}
+		s[i] = Slot{ h, idx };
+	}
+	// doubles the num of slots and reinserts every entry
+	void Grow()
+	{
+		const DSA<Slot> old = slots;
+		slots = DSA<Slot>(old.size() * 2, Slot{ 0, Empty });
+		for (auto& s : old)
+		{
+			if (s.idx != Empty)
+			{
+				Place(s.hash, s.idx);
+			}
+		}
+	}
+
+private:
+	static constexpr size_t MinCapacity = 16;
+	// num of slots is always a power of 2
+	DSA<Slot> slots;
+	size_t count = 0;
+};
@@ -0,0 +1,277 @@
+#pragma once
+#include <algorithm>
+#include "Bitset.h"
+#include "CsrGraph.h"
+#include "Permutation.h"
+
+// vertex orderings that put vertices that are visited together next to each
+// other in memory, so traversals touch fewer cache lines
+// edge directions are ignored, a vertex is close to everything it is joined to
+enum class VertexOrdering
+{
+	// reverse cuthill-mckee, keeps every edge between vertices with close
+	// indices, the best choice for meshes and road like graphs
+	ReverseCuthillMcKee,
+	// most connected vertices first, keeps the hubs of power law graphs
+	// in a few cache lines
+	Degree,
+	// the order a bredth first search first reaches the vertices in
+	Bfs
+};
+
+// the neighbours of every vertex in both directions
+class UndirectedView
+{
+public:
+	explicit UndirectedView(const CsrGraph& g)
+		:
+		out(g),
+		in(g.Transpose())
+	{}
+
+	size_t NumVertices() const
+	{
+		return out.NumVertices();
+	}
+	// num of edges touching the vertex at given idx
+	size_t Degree(size_t idx) const
+	{
+		return out.Degree(idx) + in.Degree(idx);
+	}
+	// calls f(nbr) for every vertex joined to the vertex at given idx
+	template <typename F>
+	void ForEachNeighbour(size_t idx, F f) const
+	{
+		for (size_t k = out.EdgesBegin(idx); k < out.EdgesEnd(idx); k++)
+		{
+			f(out.Target(k));
+		}
+		for (size_t k = in.EdgesBegin(idx); k < in.EdgesEnd(idx); k++)
+		{
+			f(in.Target(k));
+		}
+	}
+
+private:
+	const CsrGraph& out;
+	CsrGraph in;
+};
+
+// most connected vertices first, ties keep their original order
+inline Permutation DegreeOrder(const CsrGraph& g)
+{
+	const UndirectedView view(g);
+	const size_t n = g.NumVertices();
+	DSA<size_t> order(n);
+	for (size_t v = 0; v < n; v++)
+	{
+		order[v] = v;
+	}
+	std::stable_sort(order.data(), order.data() + n, [&](size_t a, size_t b)
+	{
+		return view.Degree(a) > view.Degree(b);
+	});
+	return Permutation(std::move(order));
+}
+
+// the order a bredth first search reaches the vertices in, each component
+// searched from its lowest idx vertex
+inline Permutation BfsOrder(const CsrGraph& g)
+{
+	const UndirectedView view(g);
+	const size_t n = g.NumVertices();
+	Bitset visited(n);
+	DSA<size_t> order(n);
+	size_t head = 0, tail = 0;
+	for (size_t root = 0; root < n; root++)
+	{
+		if (visited.test_and_set(root))
+		{
+			continue;
+		}
+		order[tail++] = root;
+		while (head < tail)
+		{
+			view.ForEachNeighbour(order[head++], [&](size_t nbr)
+			{
+				if (!visited.test_and_set(nbr))
+				{
+					order[tail++] = nbr;
+				}
+			});
+		}
+	}
+	return Permutation(std::move(order));
+}
+
+// reverse cuthill-mckee: a bredth first search per component that visits
+// the neighbours of every vertex from least to most connected, started at
+// a vertex on the far edge of the component and then reversed
+inline Permutation RcmOrder(const CsrGraph& g)
+{
+	const UndirectedView view(g);
+	const size_t n = g.NumVertices();
+
+	// trying the least connected vertices first as starting points
+	DSA<size_t> by_degree(n);
+	for (size_t v = 0; v < n; v++)
+	{
+		by_degree[v] = v;
+	}
+	std::stable_sort(by_degree.data(), by_degree.data() + n, [&](size_t a, size_t b)
+	{
+		return view.Degree(a) < view.Degree(b);
+	});
+
+	Bitset placed(n);
+	DSA<size_t> order(n);
+	size_t num_placed = 0;
+	// scratch for finding a start vertex, level n means not reached
+	DSA<size_t> level(n, n);
+	DSA<size_t> q(n);
+	DSA<size_t> nbrs(1);
+
+	// bfs from start over one component, returns the num of levels past the
+	// first and sets far to the least connected vertex of the last level
+	const auto probe = [&](size_t start, size_t& far)
+	{
+		size_t head = 0, tail = 0;
+		level[start] = 0;
+		q[tail++] = start;
+		while (head < tail)
+		{
+			const size_t cur = q[head++];
+			view.ForEachNeighbour(cur, [&](size_t nbr)
+			{
+				if (level[nbr] == n)
+				{
+					level[nbr] = level[cur] + 1;
+					q[tail++] = nbr;
+				}
+			});
+		}
+		const size_t last = level[q[tail - 1]];
+		far = q[tail - 1];
+		for (size_t i = tail; i-- > 0 && level[q[i]] == last;)
+		{
+			if (view.Degree(q[i]) < view.Degree(far))
+			{
+				far = q[i];
+			}
+		}
+		for (size_t i = 0; i < tail; i++)
+		{
+			level[q[i]] = n;
+		}
+		return last;
+	};
+
+	for (size_t s = 0; s < n; s++)
+	{
+		size_t start = by_degree[s];
+		if (placed.test(start))
+		{
+			continue;
+		}
+
+		// a vertex whose bfs has the most levels makes for the narrowest
+		// levels, found by jumping to the far end of the last bfs for as
+		// long as that adds levels (george-liu)
+		size_t far;
+		size_t depth = probe(start, far);
+		while (far != start)
+		{
+			size_t next_far;
+			const size_t next_depth = probe(far, next_far);
+			if (next_depth <= depth)
+			{
+				break;
+			}
+			start = far;
+			depth = next_depth;
+			far = next_far;
+		}
+
+		// cuthill-mckee from start, appending to order
+		size_t head = num_placed;
+		placed.set(start);
+		order[num_placed++] = start;
+		while (head < num_placed)
+		{
+			const size_t cur = order[head++];
+			size_t count = 0;
+			view.ForEachNeighbour(cur, [&](size_t nbr)
+			{
+				if (!placed.test_and_set(nbr))
+				{
+					if (count == nbrs.size())
+					{
+						DSA<size_t> bigger(count * 2);
+						std::copy(nbrs.data(), nbrs.data() + count, bigger.data());
+						nbrs = std::move(bigger);
+					}
+					nbrs[count++] = nbr;
+				}
+			});
+			std::stable_sort(nbrs.data(), nbrs.data() + count, [&](size_t a, size_t b)
+			{
+				return view.Degree(a) < view.Degree(b);
+			});
+			for (size_t i = 0; i < count; i++)
+			{
+				order[num_placed++] = nbrs[i];
+			}
+		}
+	}
+
+	std::reverse(order.data(), order.data() + n);
+	return Permutation(std::move(order));
+}
+
+// the permutation for an ordering of g
+inline Permutation ComputeOrder(const CsrGraph& g, VertexOrdering ordering)
+{
+	switch (ordering)
+	{
+	case VertexOrdering::ReverseCuthillMcKee:
+		return RcmOrder(g);
+	case VertexOrdering::Degree:
+		return DegreeOrder(g);
+	default:
+		return BfsOrder(g);
+	}
+}
+
+// g with every vertex moved to the idx p gives it
+// adjacency lists are sorted by target so they are read front to back
+inline CsrGraph Permute(const CsrGraph& g, const Permutation& p)
+{
+	const size_t n = g.NumVertices();
+	assert(p.size() == n && "Permutation does not match the graph");
+	DSA<CsrGraph::Edge> edges(g.NumEdges());
+	size_t k = 0;
+	for (size_t ni = 0; ni < n; ni++)
+	{
+		const size_t v = p.new_to_old[ni];
+		const size_t first = k;
+		for (size_t e = g.EdgesBegin(v); e < g.EdgesEnd(v); e++)
+		{
+			edges[k++] = { ni, p.old_to_new[g.Target(e)], g.Weight(e) };
+		}
+		std::sort(edges.data() + first, edges.data() + k, [](const CsrGraph::Edge& a, const CsrGraph::Edge& b)
+		{
+			return a.dst_idx < b.dst_idx;
+		});
+	}
+	return CsrGraph(n, edges);
+}
+
+// reorders the vertices of g in place and returns the permutation applied,
+// which maps the indices g had before to the ones it has now
+template <typename V>
+Permutation Reorder(Graph<V>& g, VertexOrdering ordering)
+{
+	Permutation p = ComputeOrder(CsrGraph(g), ordering);
+	g.Relabel(p);
+	return p;
+}
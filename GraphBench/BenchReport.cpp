@@ -0,0 +1,305 @@
+#include "BenchReport.h"
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+	// a column of the report, exactly one of the member pointers is set
+	struct Field
+	{
+		const char* name;
+		std::string BenchResult::* text;
+		uint64_t BenchResult::* count;
+		double BenchResult::* real;
+	};
+
+	const Field fields[] =
+	{
+		{ "bench", &BenchResult::bench, nullptr, nullptr },
+		{ "graph", &BenchResult::graph, nullptr, nullptr },
+		{ "scale", nullptr, &BenchResult::scale, nullptr },
+		{ "vertices", nullptr, &BenchResult::vertices, nullptr },
+		{ "edges", nullptr, &BenchResult::edges, nullptr },
+		{ "unit", &BenchResult::unit, nullptr, nullptr },
+		{ "units", nullptr, &BenchResult::units, nullptr },
+		{ "reps", nullptr, &BenchResult::reps, nullptr },
+		{ "ns_per_rep", nullptr, nullptr, &BenchResult::ns_per_rep },
+		{ "ns_per_unit", nullptr, nullptr, &BenchResult::ns_per_unit },
+		{ "units_per_sec", nullptr, nullptr, &BenchResult::units_per_sec },
+		{ "allocs_per_rep", nullptr, &BenchResult::allocs_per_rep, nullptr },
+		{ "alloc_bytes_per_rep", nullptr, &BenchResult::alloc_bytes_per_rep, nullptr },
+		{ "peak_rss_bytes", nullptr, &BenchResult::peak_rss_bytes, nullptr }
+	};
+
+	// writes the value of field f of r, text in quotes if quote_text is set
+	void WriteValue(std::ostream& out, const BenchResult& r, const Field& f, bool quote_text)
+	{
+		if (f.text != nullptr)
+		{
+			if (quote_text)
+			{
+				out << '"' << r.*f.text << '"';
+			}
+			else
+			{
+				out << r.*f.text;
+			}
+		}
+		else if (f.count != nullptr)
+		{
+			out << r.*f.count;
+		}
+		else
+		{
+			const std::streamsize precision = out.precision(9);
+			out << r.*f.real;
+			out.precision(precision);
+		}
+	}
+
+	// sets the field called name of r from its text, unknown names are ignored
+	// so reports with more columns can still be read
+	void SetValue(BenchResult& r, const std::string& name, const std::string& value)
+	{
+		for (const Field& f : fields)
+		{
+			if (name != f.name)
+			{
+				continue;
+			}
+			if (f.text != nullptr)
+			{
+				r.*f.text = value;
+			}
+			else if (f.count != nullptr)
+			{
+				r.*f.count = std::stoull(value);
+			}
+			else
+			{
+				r.*f.real = std::stod(value);
+			}
+			return;
+		}
+	}
+
+	// reads a json report line by line, every result is a flat object on a
+	// line of its own, as written by WriteJson
+	std::vector<BenchResult> ReadJson(std::istream& in)
+	{
+		std::vector<BenchResult> results;
+		std::string line;
+		while (std::getline(in, line))
+		{
+			const size_t start = line.find("{\"");
+			if (start == std::string::npos)
+			{
+				continue;
+			}
+			BenchResult r;
+			size_t pos = start + 1;
+			while (true)
+			{
+				const size_t key_start = line.find('"', pos);
+				if (key_start == std::string::npos)
+				{
+					break;
+				}
+				const size_t key_end = line.find('"', key_start + 1);
+				const size_t colon = line.find(':', key_end);
+				if (key_end == std::string::npos || colon == std::string::npos)
+				{
+					throw std::runtime_error("Malformed json report line: " + line);
+				}
+				const std::string key = line.substr(key_start + 1, key_end - key_start - 1);
+				size_t val_start = line.find_first_not_of(' ', colon + 1);
+				size_t val_end;
+				if (val_start != std::string::npos && line[val_start] == '"')
+				{
+					val_start++;
+					val_end = line.find('"', val_start);
+					pos = val_end + 1;
+				}
+				else
+				{
+					val_end = line.find_first_of(",}", val_start);
+					pos = val_end;
+				}
+				if (val_start == std::string::npos || val_end == std::string::npos)
+				{
+					throw std::runtime_error("Malformed json report line: " + line);
+				}
+				SetValue(r, key, line.substr(val_start, val_end - val_start));
+			}
+			results.push_back(r);
+		}
+		return results;
+	}
+
+	// splits a csv line at every comma
+	std::vector<std::string> SplitCsv(const std::string& line)
+	{
+		std::vector<std::string> cells;
+		std::istringstream ss(line);
+		std::string cell;
+		while (std::getline(ss, cell, ','))
+		{
+			cells.push_back(cell);
+		}
+		return cells;
+	}
+
+	std::vector<BenchResult> ReadCsv(std::istream& in)
+	{
+		std::vector<BenchResult> results;
+		std::string line;
+		std::getline(in, line);
+		const std::vector<std::string> header = SplitCsv(line);
+		while (std::getline(in, line))
+		{
+			if (line.empty())
+			{
+				continue;
+			}
+			const std::vector<std::string> cells = SplitCsv(line);
+			if (cells.size() != header.size())
+			{
+				throw std::runtime_error("Malformed csv report line: " + line);
+			}
+			BenchResult r;
+			for (size_t i = 0; i < cells.size(); i++)
+			{
+				SetValue(r, header[i], cells[i]);
+			}
+			results.push_back(r);
+		}
+		return results;
+	}
+
+	// identifies the same benchmark across two reports
+	std::string Key(const BenchResult& r)
+	{
+		return r.bench + " " + r.graph + " " + std::to_string(r.scale);
+	}
+}
+
+void WriteJson(std::ostream& out, const std::vector<BenchResult>& results)
+{
+	out << "{\n\"results\": [\n";
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		out << '{';
+		bool first = true;
+		for (const Field& f : fields)
+		{
+			out << (first ? "" : ", ") << '"' << f.name << "\": ";
+			WriteValue(out, results[i], f, true);
+			first = false;
+		}
+		out << (i + 1 < results.size() ? "},\n" : "}\n");
+	}
+	out << "]\n}\n";
+}
+
+void WriteCsv(std::ostream& out, const std::vector<BenchResult>& results)
+{
+	bool first = true;
+	for (const Field& f : fields)
+	{
+		out << (first ? "" : ",") << f.name;
+		first = false;
+	}
+	out << '\n';
+	for (const BenchResult& r : results)
+	{
+		first = true;
+		for (const Field& f : fields)
+		{
+			out << (first ? "" : ",");
+			WriteValue(out, r, f, false);
+			first = false;
+		}
+		out << '\n';
+	}
+}
+
+std::vector<BenchResult> ReadReport(const std::string& path)
+{
+	std::ifstream in(path);
+	if (!in)
+	{
+		throw std::runtime_error("Unable to open " + path);
+	}
+	// json reports start with a brace, anything else is read as csv
+	in >> std::ws;
+	if (in.peek() == '{')
+	{
+		return ReadJson(in);
+	}
+	return ReadCsv(in);
+}
+
+size_t CompareReports(const std::vector<BenchResult>& base, const std::vector<BenchResult>& next,
+	double threshold, std::ostream& out)
+{
+	std::map<std::string, const BenchResult*> base_by_key;
+	for (const BenchResult& r : base)
+	{
+		base_by_key[Key(r)] = &r;
+	}
+
+	out << std::left << std::setw(36) << "benchmark"
+		<< std::right << std::setw(14) << "base ns/unit"
+		<< std::setw(14) << "next ns/unit"
+		<< std::setw(10) << "change"
+		<< std::setw(14) << "base allocs"
+		<< std::setw(14) << "next allocs" << '\n';
+
+	// the rows change the format, it is put back after each one
+	const std::ios::fmtflags flags = out.flags();
+	const std::streamsize precision = out.precision();
+	size_t regressions = 0;
+	for (const BenchResult& r : next)
+	{
+		const auto it = base_by_key.find(Key(r));
+		if (it == base_by_key.end())
+		{
+			out << std::left << std::setw(36) << Key(r) << "  only in next\n";
+			continue;
+		}
+		const BenchResult& b = *it->second;
+		base_by_key.erase(it);
+
+		const double change = b.ns_per_unit > 0.0 ? (r.ns_per_unit / b.ns_per_unit - 1.0) * 100.0 : 0.0;
+		const char* verdict = "";
+		if (change > threshold)
+		{
+			verdict = "  SLOWER";
+			regressions++;
+		}
+		else if (change < -threshold)
+		{
+			verdict = "  faster";
+		}
+		out << std::left << std::setw(36) << Key(r)
+			<< std::right << std::fixed << std::setprecision(3)
+			<< std::setw(14) << b.ns_per_unit
+			<< std::setw(14) << r.ns_per_unit
+			<< std::setprecision(1) << std::showpos << std::setw(9) << change << '%' << std::noshowpos
+			<< std::setw(14) << b.allocs_per_rep
+			<< std::setw(14) << r.allocs_per_rep
+			<< verdict << '\n';
+		out.flags(flags);
+		out.precision(precision);
+	}
+	for (const auto& kv : base_by_key)
+	{
+		out << std::left << std::setw(36) << kv.first << "  only in base\n";
+	}
+
+	out << regressions << " regression(s) over " << threshold << "%\n";
+	return regressions;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// the measurements of one benchmark on one graph
+struct BenchResult
+{
+	// what was measured and on which graph
+	std::string bench;
+	std::string graph;
+	uint64_t scale = 0;
+	uint64_t vertices = 0;
+	uint64_t edges = 0;
+	// what one unit of work is, "edge" for traversals and builds, where
+	// units_per_sec is traversed edges per second (teps), "lookup" for indices
+	std::string unit;
+	// units of work done by a single repetition
+	uint64_t units = 0;
+	uint64_t reps = 0;
+	// median time of a repetition
+	double ns_per_rep = 0.0;
+	double ns_per_unit = 0.0;
+	double units_per_sec = 0.0;
+	// heap allocations made by an average repetition
+	uint64_t allocs_per_rep = 0;
+	uint64_t alloc_bytes_per_rep = 0;
+	// peak resident memory of the process once the benchmark finished
+	uint64_t peak_rss_bytes = 0;
+};
+
+// writes the results as a json object with one result per line
+void WriteJson(std::ostream& out, const std::vector<BenchResult>& results);
+// writes the results as csv with a header row
+void WriteCsv(std::ostream& out, const std::vector<BenchResult>& results);
+// reads a report written by either of the above, throws if it can't
+std::vector<BenchResult> ReadReport(const std::string& path);
+
+// prints how every benchmark in both reports changed from base to next and
+// returns the num that got slower per unit by more than threshold percent
+size_t CompareReports(const std::vector<BenchResult>& base, const std::vector<BenchResult>& next,
+	double threshold, std::ostream& out);
@@ -0,0 +1,281 @@
+#include "Benchmarks.h"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include "CompressedCsrGraph.h"
+#include "CsrGraph.h"
+#include "Graph.h"
+#include "GraphGenerators.h"
+#include "MemoryStats.h"
+#include "ThreadPool.h"
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	// upper bound on the repetitions of one benchmark, the times are kept in
+	// an array reserved up front so timing doesn't allocate
+	constexpr size_t MaxReps = 1 << 16;
+
+	// results are summed into this so the work can't be optimized away
+	volatile size_t sink = 0;
+
+	double Nanoseconds(Clock::duration d)
+	{
+		return double(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+	}
+
+	// runs run() until the config's minimum time and repetitions are
+	// reached and fills in a copy of info with the median time and the
+	// allocations of an average repetition, run returns a checksum
+	template <typename F>
+	BenchResult Measure(const std::string& bench, const BenchResult& info, const char* unit, uint64_t units,
+		const BenchConfig& config, F run)
+	{
+		// warm up caches and anything built lazily
+		sink = sink + run();
+
+		std::vector<double> times;
+		times.reserve(MaxReps);
+		const AllocCounts before = CurrentAllocs();
+		const Clock::time_point start = Clock::now();
+		do
+		{
+			const Clock::time_point t0 = Clock::now();
+			sink = sink + run();
+			times.push_back(Nanoseconds(Clock::now() - t0));
+		} while (times.size() < MaxReps &&
+			(times.size() < config.min_reps || Nanoseconds(Clock::now() - start) < config.min_seconds * 1e9));
+		const AllocCounts after = CurrentAllocs();
+
+		std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+		BenchResult r = info;
+		r.bench = bench;
+		r.unit = unit;
+		r.units = units;
+		r.reps = times.size();
+		r.ns_per_rep = times[times.size() / 2];
+		r.ns_per_unit = units > 0 ? r.ns_per_rep / double(units) : 0.0;
+		r.units_per_sec = r.ns_per_rep > 0.0 ? double(units) * 1e9 / r.ns_per_rep : 0.0;
+		r.allocs_per_rep = (after.count - before.count) / r.reps;
+		r.alloc_bytes_per_rep = (after.bytes - before.bytes) / r.reps;
+		r.peak_rss_bytes = PeakResidentBytes();
+		return r;
+	}
+
+	// the edges of a graph of the given kind with 2^scale vertices
+	GraphBuilder Generate(const std::string& kind, uint64_t scale, const BenchConfig& config, ThreadPool& pool)
+	{
+		const size_t n = size_t(1) << scale;
+		if (kind == "rmat")
+		{
+			return GenerateRmat(size_t(scale), size_t(config.edge_factor), config.seed, pool);
+		}
+		if (kind == "er")
+		{
+			return GenerateErdosRenyi(n, n * size_t(config.edge_factor), config.seed, pool);
+		}
+		if (kind == "grid")
+		{
+			const size_t rows = size_t(1) << (scale / 2);
+			return GenerateGrid(rows, n / rows, config.seed, pool);
+		}
+		if (kind == "ba")
+		{
+			return GenerateBarabasiAlbert(n, size_t(config.edge_factor), config.seed, pool);
+		}
+		throw std::invalid_argument("Unknown graph kind " + kind);
+	}
+
+	// a traversal from src to the vertex furthest from it, which makes the
+	// search visit (nearly) everything src reaches
+	struct Traversal
+	{
+		size_t src;
+		size_t dst;
+		// num of edges leaving the vertices src reaches
+		size_t reached_edges;
+		// the vertex a dfs from src finds last, and the num of edges the dfs
+		// scans before finding it, a dfs stops as soon as it finds its dst
+		// so dst says nothing about how far it goes
+		size_t dfs_dst;
+		size_t dfs_edges;
+	};
+
+	// fills in the dfs half of t by replaying the search Graph::DFS_idx makes,
+	// scanning the adj lists of g in the same order
+	void PickDfsTarget(const Graph<size_t>& g, Traversal& t)
+	{
+		using Iter = SinglyLinkedList<Graph<size_t>::Edge>::const_iterator;
+		const size_t n = g.GetVertices().size();
+		std::vector<bool> visited(n);
+		std::vector<std::pair<size_t, Iter>> stack;
+		size_t scanned = 0;
+		visited[t.src] = true;
+		stack.emplace_back(t.src, g.GetAdjList_idx(t.src).begin());
+		t.dfs_dst = t.src;
+		t.dfs_edges = 0;
+		while (!stack.empty())
+		{
+			Iter& next = stack.back().second;
+			if (next == g.GetAdjList_idx(stack.back().first).end())
+			{
+				stack.pop_back();
+				continue;
+			}
+			const size_t nbr = next->dst_idx;
+			++next;
+			scanned++;
+			if (visited[nbr])
+			{
+				continue;
+			}
+			visited[nbr] = true;
+			t.dfs_dst = nbr;
+			t.dfs_edges = scanned;
+			stack.emplace_back(nbr, g.GetAdjList_idx(nbr).begin());
+		}
+	}
+
+	// up to num_sources traversals from random vertices with edges
+	std::vector<Traversal> PickTraversals(const CsrGraph& csr, const BenchConfig& config)
+	{
+		const size_t n = csr.NumVertices();
+		std::vector<Traversal> traversals;
+		for (size_t i = 0; i < 64 * config.num_sources && traversals.size() < config.num_sources; i++)
+		{
+			const size_t src = size_t(EdgeRng(config.seed, i).Below(n));
+			if (csr.Degree(src) == 0)
+			{
+				continue;
+			}
+			const DSA<size_t> dist = csr.BFS_dist(src);
+			Traversal t = { src, src, 0, src, 0 };
+			for (size_t v = 0; v < n; v++)
+			{
+				if (dist[v] == n)
+				{
+					continue;
+				}
+				t.reached_edges += csr.Degree(v);
+				if (dist[v] > dist[t.dst])
+				{
+					t.dst = v;
+				}
+			}
+			traversals.push_back(t);
+		}
+		return traversals;
+	}
+
+	void LogResult(std::ostream& log, const BenchResult& r)
+	{
+		log << "  " << r.bench << ": " << r.ns_per_unit << " ns/" << r.unit << ", "
+			<< r.units_per_sec / 1e6 << " M " << r.unit << "s/s, "
+			<< r.allocs_per_rep << " allocs/rep, " << r.reps << " reps\n";
+	}
+}
+
+std::vector<BenchResult> RunBenchmarks(const BenchConfig& config, std::ostream& log)
+{
+	ThreadPool pool(size_t(config.threads));
+	std::vector<BenchResult> results;
+	const auto add = [&](const BenchResult& r)
+	{
+		LogResult(log, r);
+		results.push_back(r);
+	};
+
+	for (const std::string& kind : config.graphs)
+	{
+		for (const uint64_t scale : config.scales)
+		{
+			GraphBuilder builder = Generate(kind, scale, config, pool);
+			builder.Symmetrize().MergeParallelEdges(ParallelEdges::First);
+			const CsrGraph csr = builder.BuildCsr(pool);
+
+			BenchResult info;
+			info.graph = kind;
+			info.scale = scale;
+			info.vertices = csr.NumVertices();
+			info.edges = csr.NumEdges();
+			log << kind << " scale " << scale << ": " << info.vertices << " vertices, " << info.edges << " edges\n";
+
+			add(Measure("build_csr", info, "edge", builder.NumEdges(), config, [&]()
+			{
+				return builder.BuildCsr(pool).NumEdges();
+			}));
+
+			Graph<size_t> g;
+			FillGraph(g, builder, pool, [](size_t i) { return i; });
+			std::vector<Traversal> traversals = PickTraversals(csr, config);
+			uint64_t traversed = 0;
+			uint64_t dfs_traversed = 0;
+			for (Traversal& t : traversals)
+			{
+				PickDfsTarget(g, t);
+				traversed += t.reached_edges;
+				dfs_traversed += t.dfs_edges;
+			}
+
+			add(Measure("graph_bfs", info, "edge", traversed, config, [&]()
+			{
+				size_t sum = 0;
+				for (const Traversal& t : traversals)
+				{
+					sum += g.BFS_idx(t.src, t.dst).size();
+				}
+				return sum;
+			}));
+			add(Measure("graph_dfs", info, "edge", dfs_traversed, config, [&]()
+			{
+				size_t sum = 0;
+				for (const Traversal& t : traversals)
+				{
+					sum += g.DFS_idx(t.src, t.dfs_dst).size();
+				}
+				return sum;
+			}));
+			add(Measure("csr_bfs", info, "edge", traversed, config, [&]()
+			{
+				size_t sum = 0;
+				for (const Traversal& t : traversals)
+				{
+					sum += csr.BFS_dist(t.src)[t.dst];
+				}
+				return sum;
+			}));
+			const CompressedCsrGraph compressed(csr);
+			add(Measure("compressed_bfs", info, "edge", traversed, config, [&]()
+			{
+				size_t sum = 0;
+				for (const Traversal& t : traversals)
+				{
+					sum += compressed.BFS_dist(t.src)[t.dst];
+				}
+				return sum;
+			}));
+
+			// every vertex looked up once, in a random order
+			std::vector<size_t> lookups(g.GetVertices().size());
+			for (size_t i = 0; i < lookups.size(); i++)
+			{
+				lookups[i] = i;
+			}
+			for (size_t i = lookups.size(); i-- > 1;)
+			{
+				std::swap(lookups[i], lookups[size_t(EdgeRng(config.seed, i).Below(i + 1))]);
+			}
+			add(Measure("vertex_lookup", info, "lookup", lookups.size(), config, [&]()
+			{
+				size_t sum = 0;
+				for (const size_t val : lookups)
+				{
+					sum += g.GetVertIdx(val);
+				}
+				return sum;
+			}));
+		}
+	}
+	return results;
+}
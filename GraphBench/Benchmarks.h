@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "BenchReport.h"
+
+// what to run and on which graphs
+struct BenchConfig
+{
+	// generated topologies, any of rmat, er, grid and ba
+	std::vector<std::string> graphs = { "rmat", "er", "grid", "ba" };
+	// every graph is made at 2^scale vertices for each scale
+	std::vector<uint64_t> scales = { 10, 14, 18 };
+	// average num of edges generated per vertex, before symmetrizing
+	uint64_t edge_factor = 8;
+	uint64_t seed = 1;
+	// num of traversal sources per graph
+	uint64_t num_sources = 4;
+	// every benchmark repeats until both of these are reached
+	double min_seconds = 0.25;
+	uint64_t min_reps = 3;
+	// threads for generating and building, 0 for one per hardware thread
+	uint64_t threads = 0;
+};
+
+// runs every benchmark on every graph of the config and returns the
+// results, progress is written to log
+std::vector<BenchResult> RunBenchmarks(const BenchConfig& config, std::ostream& log);
@@ -0,0 +1,176 @@
+// standalone benchmarks of the graph data structures, needs no window or d3d
+//
+// GraphBench [run] [options]   runs the benchmarks and writes a report
+//   --graphs rmat,er,grid,ba   topologies to generate
+//   --scales 10,14,18          log2 of the num of vertices of each graph
+//   --edge-factor 8            edges generated per vertex
+//   --seed 1                   seed of the generators and sources
+//   --sources 4                traversal sources per graph
+//   --min-time 0.25            seconds each benchmark repeats for at least
+//   --threads 0                threads for generating, 0 for all
+//   --format json|csv          report format, json by default
+//   --out path                 file to write the report to, stdout by default
+//
+// GraphBench compare base next [--threshold 5]
+//   diffs two reports (json or csv) and exits with 1 if any benchmark got
+//   slower per unit of work by more than threshold percent
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "BenchReport.h"
+#include "Benchmarks.h"
+
+namespace
+{
+	// comma separated list
+	std::vector<std::string> SplitList(const std::string& list)
+	{
+		std::vector<std::string> items;
+		std::istringstream ss(list);
+		std::string item;
+		while (std::getline(ss, item, ','))
+		{
+			if (!item.empty())
+			{
+				items.push_back(item);
+			}
+		}
+		return items;
+	}
+
+	int Run(const std::vector<std::string>& args)
+	{
+		BenchConfig config;
+		std::string format = "json";
+		std::string out_path;
+		for (size_t i = 0; i < args.size(); i++)
+		{
+			const std::string& opt = args[i];
+			if (i + 1 >= args.size())
+			{
+				throw std::invalid_argument("Missing value for " + opt);
+			}
+			const std::string& val = args[++i];
+			if (opt == "--graphs")
+			{
+				config.graphs = SplitList(val);
+			}
+			else if (opt == "--scales")
+			{
+				config.scales.clear();
+				for (const std::string& s : SplitList(val))
+				{
+					config.scales.push_back(std::stoull(s));
+				}
+			}
+			else if (opt == "--edge-factor")
+			{
+				config.edge_factor = std::stoull(val);
+			}
+			else if (opt == "--seed")
+			{
+				config.seed = std::stoull(val);
+			}
+			else if (opt == "--sources")
+			{
+				config.num_sources = std::stoull(val);
+			}
+			else if (opt == "--min-time")
+			{
+				config.min_seconds = std::stod(val);
+			}
+			else if (opt == "--threads")
+			{
+				config.threads = std::stoull(val);
+			}
+			else if (opt == "--format")
+			{
+				format = val;
+			}
+			else if (opt == "--out")
+			{
+				out_path = val;
+			}
+			else
+			{
+				throw std::invalid_argument("Unknown option " + opt);
+			}
+		}
+		if (format != "json" && format != "csv")
+		{
+			throw std::invalid_argument("Unknown format " + format);
+		}
+
+		// progress goes to stderr so stdout holds only the report
+		const std::vector<BenchResult> results = RunBenchmarks(config, std::cerr);
+
+		std::ofstream file;
+		if (!out_path.empty())
+		{
+			file.open(out_path);
+			if (!file)
+			{
+				throw std::runtime_error("Unable to create " + out_path);
+			}
+		}
+		std::ostream& out = out_path.empty() ? std::cout : file;
+		if (format == "json")
+		{
+			WriteJson(out, results);
+		}
+		else
+		{
+			WriteCsv(out, results);
+		}
+		return 0;
+	}
+
+	int Compare(const std::vector<std::string>& args)
+	{
+		std::vector<std::string> paths;
+		double threshold = 5.0;
+		for (size_t i = 0; i < args.size(); i++)
+		{
+			if (args[i] == "--threshold" && i + 1 < args.size())
+			{
+				threshold = std::stod(args[++i]);
+			}
+			else
+			{
+				paths.push_back(args[i]);
+			}
+		}
+		if (paths.size() != 2)
+		{
+			throw std::invalid_argument("compare needs a base and a next report");
+		}
+		const size_t regressions = CompareReports(ReadReport(paths[0]), ReadReport(paths[1]), threshold, std::cout);
+		return regressions > 0 ? 1 : 0;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<std::string> args(argv + 1, argv + argc);
+	try
+	{
+		if (!args.empty() && args[0] == "compare")
+		{
+			return Compare(std::vector<std::string>(args.begin() + 1, args.end()));
+		}
+		if (!args.empty() && args[0] == "run")
+		{
+			args.erase(args.begin());
+		}
+		return Run(args);
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "GraphBench: " << e.what() << '\n';
+		return 2;
+	}
+}
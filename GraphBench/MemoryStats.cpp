@@ -0,0 +1,102 @@
+#include "MemoryStats.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#ifdef _WIN32
+#include "ChiliWin.h"
+#include <Psapi.h>
+#pragma comment(lib, "Psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+	// relaxed is enough, the counts are only read between benchmarks
+	std::atomic<uint64_t> alloc_count{ 0 };
+	std::atomic<uint64_t> alloc_bytes{ 0 };
+
+	void* CountedAlloc(std::size_t size)
+	{
+		alloc_count.fetch_add(1, std::memory_order_relaxed);
+		alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+		return std::malloc(size > 0 ? size : 1);
+	}
+}
+
+// every form of new ends up in CountedAlloc and every delete in free
+void* operator new(std::size_t size)
+{
+	void* const p = CountedAlloc(size);
+	if (p == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return p;
+}
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	return CountedAlloc(size);
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+	return CountedAlloc(size);
+}
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+void operator delete[](void* p) noexcept
+{
+	std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+void operator delete[](void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+	std::free(p);
+}
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+	std::free(p);
+}
+
+AllocCounts CurrentAllocs()
+{
+	return AllocCounts{ alloc_count.load(std::memory_order_relaxed), alloc_bytes.load(std::memory_order_relaxed) };
+}
+
+uint64_t PeakResidentBytes()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return 0;
+	}
+	return uint64_t(counters.PeakWorkingSetSize);
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+	{
+		return 0;
+	}
+#ifdef __APPLE__
+	// bytes on macos
+	return uint64_t(usage.ru_maxrss);
+#else
+	// kilobytes everywhere else
+	return uint64_t(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
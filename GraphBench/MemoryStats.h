@@ -0,0 +1,16 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// num of heap allocations and bytes requested through operator new since
+// the program started, counted by the replacement operators in MemoryStats.cpp
+struct AllocCounts
+{
+	uint64_t count;
+	uint64_t bytes;
+};
+
+// the allocations so far, subtract two of them to get the ones in between
+AllocCounts CurrentAllocs();
+// the most memory the process has had resident at once, in bytes
+uint64_t PeakResidentBytes();
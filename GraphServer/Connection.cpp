@@ -0,0 +1,206 @@
+#include "Connection.h"
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#ifdef _WIN32
+#include "ChiliWin.h"
+#include <winsock2.h>
+#include <afunix.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#ifdef _WIN32
+	using Socket = SOCKET;
+	const Socket BadSocket = INVALID_SOCKET;
+	void CloseSocket(Socket s)
+	{
+		closesocket(s);
+	}
+	void RemoveFile(const std::string& path)
+	{
+		DeleteFileA(path.c_str());
+	}
+#else
+	using Socket = int;
+	const Socket BadSocket = -1;
+	void CloseSocket(Socket s)
+	{
+		close(s);
+	}
+	void RemoveFile(const std::string& path)
+	{
+		unlink(path.c_str());
+	}
+#endif
+#ifdef MSG_NOSIGNAL
+	// a client that hung up is reported as an error instead of killing us
+	const int SendFlags = MSG_NOSIGNAL;
+#else
+	const int SendFlags = 0;
+#endif
+
+	// drops the \r of a line ending in \r\n
+	void TrimCr(std::string& line)
+	{
+		if (!line.empty() && line.back() == '\r')
+		{
+			line.pop_back();
+		}
+	}
+
+	// one accepted client of a unix socket
+	class SocketConnection : public Connection
+	{
+	public:
+		explicit SocketConnection(Socket sock)
+			:
+			sock(sock)
+		{}
+		~SocketConnection()
+		{
+			CloseSocket(sock);
+		}
+
+		bool ReadLine(std::string& line) override
+		{
+			while (true)
+			{
+				const size_t end = buffer.find('\n', pos);
+				if (end != std::string::npos)
+				{
+					line.assign(buffer, pos, end - pos);
+					pos = end + 1;
+					TrimCr(line);
+					return true;
+				}
+				// drop what has been read already before reading more
+				buffer.erase(0, pos);
+				pos = 0;
+
+				char chunk[4096];
+				const int got = recv(sock, chunk, int(sizeof(chunk)), 0);
+				if (got <= 0)
+				{
+					// the last line may have no line break
+					if (buffer.empty())
+					{
+						return false;
+					}
+					line.swap(buffer);
+					buffer.clear();
+					TrimCr(line);
+					return true;
+				}
+				buffer.append(chunk, size_t(got));
+			}
+		}
+		void Write(const std::string& data) override
+		{
+			// once the client is gone everything else for it is dropped
+			for (size_t sent = 0; sent < data.size() && !broken;)
+			{
+				const int n = send(sock, data.data() + sent, int(data.size() - sent), SendFlags);
+				if (n <= 0)
+				{
+					broken = true;
+				}
+				else
+				{
+					sent += size_t(n);
+				}
+			}
+		}
+
+	private:
+		Socket sock;
+		// bytes received and not returned yet start at pos, only touched by reads
+		std::string buffer;
+		size_t pos = 0;
+		// only touched by writes
+		bool broken = false;
+	};
+}
+
+StdioConnection::StdioConnection()
+{
+	// cin flushes cout before every read unless untied, which would race
+	// with the writes made on other threads
+	std::cin.tie(nullptr);
+}
+
+bool StdioConnection::ReadLine(std::string& line)
+{
+	if (!std::getline(std::cin, line))
+	{
+		return false;
+	}
+	TrimCr(line);
+	return true;
+}
+
+void StdioConnection::Write(const std::string& data)
+{
+	std::cout.write(data.data(), std::streamsize(data.size()));
+	std::cout.flush();
+}
+
+UnixSocketListener::UnixSocketListener(const std::string& path)
+	:
+	path(path),
+	sock(intptr_t(BadSocket))
+{
+#ifdef _WIN32
+	WSADATA wsa;
+	if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0)
+	{
+		throw std::runtime_error("Unable to start winsock");
+	}
+#endif
+	sockaddr_un addr;
+	std::memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (path.size() >= sizeof(addr.sun_path))
+	{
+		throw std::runtime_error("Socket path is too long: " + path);
+	}
+	std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+	const Socket s = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (s == BadSocket)
+	{
+		throw std::runtime_error("Unable to create a socket");
+	}
+	// a socket file left by an earlier run would make bind fail
+	RemoveFile(path);
+	if (bind(s, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 || listen(s, SOMAXCONN) != 0)
+	{
+		CloseSocket(s);
+		throw std::runtime_error("Unable to listen on " + path);
+	}
+	sock = intptr_t(s);
+}
+
+UnixSocketListener::~UnixSocketListener()
+{
+	CloseSocket(Socket(sock));
+	RemoveFile(path);
+#ifdef _WIN32
+	WSACleanup();
+#endif
+}
+
+std::unique_ptr<Connection> UnixSocketListener::Accept()
+{
+	const Socket client = accept(Socket(sock), nullptr, nullptr);
+	if (client == BadSocket)
+	{
+		throw std::runtime_error("Unable to accept on " + path);
+	}
+	return std::unique_ptr<Connection>(new SocketConnection(client));
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// a two way stream of lines between the server and one client
+// reads happen on one thread and writes on another, so the two must not
+// share state
+class Connection
+{
+public:
+	virtual ~Connection() = default;
+	// reads the next line without its line break (or a trailing \r)
+	// returns false once the client has nothing more to send
+	virtual bool ReadLine(std::string& line) = 0;
+	// writes data and sends it on right away
+	virtual void Write(const std::string& data) = 0;
+};
+
+// the process's stdin and stdout
+class StdioConnection : public Connection
+{
+public:
+	StdioConnection();
+	bool ReadLine(std::string& line) override;
+	void Write(const std::string& data) override;
+};
+
+// listens for clients on a unix domain socket, afunix on windows
+class UnixSocketListener
+{
+public:
+	// binds path, replacing any socket file already there
+	// throws if the socket can't be set up
+	explicit UnixSocketListener(const std::string& path);
+	UnixSocketListener(const UnixSocketListener&) = delete;
+	UnixSocketListener& operator=(const UnixSocketListener&) = delete;
+	~UnixSocketListener();
+
+	// waits for the next client, throws if the socket failed
+	std::unique_ptr<Connection> Accept();
+
+private:
+	std::string path;
+	// a SOCKET on windows, a file descriptor everywhere else
+	intptr_t sock;
+};
@@ -0,0 +1,123 @@
+// answers path queries on a graph without a window, see QueryEngine.h for
+// the request and response lines
+//
+// GraphServer graph [options]   graph is a .graph file or a .csv to convert
+//   --socket path               serve clients of a unix socket at path
+//                               instead of stdin and stdout
+//   --threads 0                 threads answering queries, 0 for all
+//   --queue 1024                requests queued before clients have to wait
+//   --per-client 64             requests a client may have unanswered (or
+//                               answered but not read yet) before it waits
+//   --csv-layout 3,12,14,3      src, count, first neighbour col and stride
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Connection.h"
+#include "QueryEngine.h"
+#include "QueryServer.h"
+
+namespace
+{
+	// src,count,first,stride as a CsvGraphLayout
+	CsvGraphLayout ParseLayout(const std::string& list)
+	{
+		std::vector<size_t> cols;
+		std::istringstream ss(list);
+		std::string item;
+		while (std::getline(ss, item, ','))
+		{
+			cols.push_back(std::stoull(item));
+		}
+		if (cols.size() != 4)
+		{
+			throw std::invalid_argument("--csv-layout takes 4 columns, not " + list);
+		}
+		return { cols[0], cols[1], cols[2], cols[3] };
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const std::vector<std::string> args(argv + 1, argv + argc);
+	try
+	{
+		std::string graph_path;
+		std::string socket_path;
+		size_t threads = 0;
+		size_t max_pending = 1024;
+		size_t max_in_flight = 64;
+		// the layout of the csv the game loads
+		CsvGraphLayout layout = { 3, 12, 14, 3 };
+		for (size_t i = 0; i < args.size(); i++)
+		{
+			const std::string& opt = args[i];
+			if (opt.compare(0, 2, "--") != 0)
+			{
+				if (!graph_path.empty())
+				{
+					throw std::invalid_argument("Only one graph can be served");
+				}
+				graph_path = opt;
+				continue;
+			}
+			if (i + 1 >= args.size())
+			{
+				throw std::invalid_argument("Missing value for " + opt);
+			}
+			const std::string& val = args[++i];
+			if (opt == "--socket")
+			{
+				socket_path = val;
+			}
+			else if (opt == "--threads")
+			{
+				threads = std::stoull(val);
+			}
+			else if (opt == "--queue")
+			{
+				max_pending = std::stoull(val);
+			}
+			else if (opt == "--per-client")
+			{
+				max_in_flight = std::stoull(val);
+			}
+			else if (opt == "--csv-layout")
+			{
+				layout = ParseLayout(val);
+			}
+			else
+			{
+				throw std::invalid_argument("Unknown option " + opt);
+			}
+		}
+		if (graph_path.empty())
+		{
+			throw std::invalid_argument("No graph given");
+		}
+
+		const QueryEngine engine(graph_path, layout);
+		// stdout may be the client, so everything else goes to stderr
+		std::cerr << "GraphServer: loaded " << engine.NumVertices() << " vertices, "
+			<< engine.NumEdges() << " edges\n";
+
+		QueryServer server(engine, threads, max_pending, max_in_flight);
+		if (socket_path.empty())
+		{
+			server.Serve(std::unique_ptr<Connection>(new StdioConnection()));
+		}
+		else
+		{
+			UnixSocketListener listener(socket_path);
+			std::cerr << "GraphServer: listening on " << socket_path << '\n';
+			server.Listen(listener);
+		}
+		return 0;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "GraphServer: " << e.what() << '\n';
+		return 2;
+	}
+}
@@ -0,0 +1,145 @@
+#include "QueryEngine.h"
+#include <sstream>
+#include <stdexcept>
+#include "GraphFile.h"
+
+QueryEngine::QueryEngine(const std::string& path, const CsvGraphLayout& layout)
+	:
+	QueryEngine(PrepareGraphFile(path, layout))
+{}
+
+QueryEngine::QueryEngine(const std::string& graph_path)
+	:
+	graph(GraphFile::Map(graph_path)),
+	ids(graph.NumVertices()),
+	reach(graph)
+{
+	// the file is valid by now, so this only fails if the payloads aren't ids
+	bool has_ids = true;
+	try
+	{
+		// the arrays were checked when graph was mapped
+		const MappedGraph<uint64_t> mapped(graph_path, false);
+		for (size_t i = 0; i < ids.size(); i++)
+		{
+			ids[i] = mapped.GetPayload(i);
+		}
+	}
+	catch (const std::runtime_error&)
+	{
+		has_ids = false;
+	}
+	for (size_t i = 0; i < ids.size(); i++)
+	{
+		if (!has_ids)
+		{
+			ids[i] = i;
+		}
+		if (idx_of.Find(ids[i], ids) < i)
+		{
+			throw std::runtime_error("Vertex id " + std::to_string(ids[i]) + " appears twice in " + graph_path);
+		}
+		idx_of.Insert(ids[i], i);
+	}
+}
+
+std::string QueryEngine::PrepareGraphFile(const std::string& path, const CsvGraphLayout& layout)
+{
+	const std::string csv_ext = ".csv";
+	if (path.size() < csv_ext.size() || path.compare(path.size() - csv_ext.size(), csv_ext.size(), csv_ext) != 0)
+	{
+		return path;
+	}
+	const std::string graph_path = path.substr(0, path.size() - csv_ext.size()) + ".graph";
+	if (!GraphFileIsStale(graph_path, path))
+	{
+		try
+		{
+			GraphFile::Map(graph_path);
+			return graph_path;
+		}
+		catch (const std::runtime_error&)
+		{
+			// the old conversion is unreadable
+		}
+	}
+	ConvertCsvToGraphFile(path, graph_path, layout);
+	return graph_path;
+}
+
+std::string QueryEngine::Answer(const std::string& request) const
+{
+	std::istringstream in(request);
+	std::string cmd;
+	in >> cmd;
+	try
+	{
+		if (cmd == "stats")
+		{
+			return "ok " + std::to_string(NumVertices()) + " " + std::to_string(NumEdges());
+		}
+		if (cmd != "bfs" && cmd != "dfs" && cmd != "sp" && cmd != "reach")
+		{
+			return "err unknown command " + cmd;
+		}
+
+		uint64_t src_id, dst_id;
+		std::string extra;
+		if (!(in >> src_id >> dst_id) || in >> extra)
+		{
+			return "err " + cmd + " takes SRC DST";
+		}
+		const size_t src = ToIdx(src_id);
+		const size_t dst = ToIdx(dst_id);
+
+		std::string out = "ok";
+		if (cmd == "reach")
+		{
+			out += reach.CanReach(src, dst) ? " 1" : " 0";
+		}
+		else if (cmd == "sp")
+		{
+			const WeightedPath wp = graph.Dijkstra_idx(src, dst);
+			std::ostringstream dist;
+			dist << wp.distance;
+			out += " " + dist.str();
+			AppendPath(out, wp.path);
+		}
+		else
+		{
+			// a path that can't exist isn't searched for
+			if (reach.CanReach(src, dst))
+			{
+				AppendPath(out, cmd == "bfs" ? graph.BFS_idx(src, dst) : graph.DFS_idx(src, dst));
+			}
+			else
+			{
+				out += " 0";
+			}
+		}
+		return out;
+	}
+	catch (const std::exception& e)
+	{
+		return std::string("err ") + e.what();
+	}
+}
+
+size_t QueryEngine::ToIdx(uint64_t id) const
+{
+	const size_t idx = idx_of.Find(id, ids);
+	if (idx == ids.size())
+	{
+		throw std::out_of_range("no vertex " + std::to_string(id));
+	}
+	return idx;
+}
+
+void QueryEngine::AppendPath(std::string& out, const DSA<size_t>& path) const
+{
+	out += " " + std::to_string(path.size());
+	for (size_t i = 0; i < path.size(); i++)
+	{
+		out += " " + std::to_string(ids[path[i]]);
+	}
+}
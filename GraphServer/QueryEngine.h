@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "CsrGraph.h"
+#include "GraphCsv.h"
+#include "ReachabilityIndex.h"
+#include "VertexHash.h"
+
+// answers queries on one graph loaded at startup, the graph never changes
+// so any num of threads can answer at once
+//
+// a request is one line, vertices are given by their id, which is the
+// payload of the vertex in the graph file (the vertex num for graphs
+// converted from csv) or its idx if the file has no 64 bit payloads
+//   bfs SRC DST     fewest edges path      ok N V1 .. VN
+//   dfs SRC DST     any path               ok N V1 .. VN
+//   sp SRC DST      least weight path      ok WEIGHT N V1 .. VN
+//   reach SRC DST   is DST reachable       ok 0|1
+//   stats           size of the graph      ok VERTICES EDGES
+// a missing path has N = 0 (and WEIGHT inf), a bad request gets
+// err MESSAGE, every response is a single line
+class QueryEngine
+{
+public:
+	// loads a graph file, or a csv laid out as given which is converted to
+	// a graph file next to it on first use and whenever it changes
+	QueryEngine(const std::string& path, const CsvGraphLayout& layout);
+
+	// the response line to a request line, both without the line break
+	std::string Answer(const std::string& request) const;
+
+	size_t NumVertices() const
+	{
+		return graph.NumVertices();
+	}
+	size_t NumEdges() const
+	{
+		return graph.NumEdges();
+	}
+
+private:
+	// maps the graph file at graph_path
+	explicit QueryEngine(const std::string& graph_path);
+	// the path of the graph file for path, converting a csv if needed
+	static std::string PrepareGraphFile(const std::string& path, const CsvGraphLayout& layout);
+	// the idx of the vertex with given id, throws if there is none
+	size_t ToIdx(uint64_t id) const;
+	// appends N and the ids of the path
+	void AppendPath(std::string& out, const DSA<size_t>& path) const;
+
+private:
+	CsrGraph graph;
+	// id of every vertex and the idx of every id
+	DSA<uint64_t> ids;
+	VertexIndex<uint64_t> idx_of;
+	ReachabilityIndex reach;
+};
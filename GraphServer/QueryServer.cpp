@@ -0,0 +1,187 @@
+#include "QueryServer.h"
+#include <map>
+
+// a connected client and the answers waiting to be written back to it
+struct QueryServer::Session
+{
+	std::unique_ptr<Connection> conn;
+	std::mutex mtx;
+	// signalled when an answer arrives or the client stops sending
+	std::condition_variable ready;
+	// signalled when answers have been written, so the reader may send more
+	std::condition_variable room;
+	// seq of the next answer the client gets, every one before it is written
+	uint64_t next_to_write = 0;
+	// answers not written yet, keyed by seq, they come back in any order
+	std::map<uint64_t, std::string> waiting;
+	// set once the client has nothing more to send, along with how much it sent
+	bool reading_done = false;
+	uint64_t num_requests = 0;
+};
+
+QueryServer::QueryServer(const QueryEngine& engine, size_t num_threads, size_t max_pending, size_t max_in_flight)
+	:
+	engine(engine),
+	max_pending(max_pending > 0 ? max_pending : 1),
+	max_in_flight(max_in_flight > 0 ? max_in_flight : 1),
+	pool(num_threads)
+{
+	workers = std::thread([this]()
+	{
+		pool.RunOnAll([this](size_t)
+		{
+			WorkerLoop();
+		});
+	});
+}
+
+QueryServer::~QueryServer()
+{
+	{
+		std::unique_lock<std::mutex> lock(sessions_mtx);
+		sessions_done.wait(lock, [this] { return num_sessions == 0; });
+	}
+	{
+		std::lock_guard<std::mutex> lock(queue_mtx);
+		stopping = true;
+	}
+	not_empty.notify_all();
+	workers.join();
+}
+
+void QueryServer::Serve(std::unique_ptr<Connection> conn)
+{
+	const std::shared_ptr<Session> session = std::make_shared<Session>();
+	session->conn = std::move(conn);
+	Session& s = *session;
+	std::thread writer([this, &s]() { WriterLoop(s); });
+
+	uint64_t seq = 0;
+	std::string line;
+	while (s.conn->ReadLine(line))
+	{
+		if (line == "quit")
+		{
+			break;
+		}
+		if (line.empty())
+		{
+			continue;
+		}
+		{
+			// a client that doesn't read its answers stops being read from
+			// here, before it can fill the shared queue
+			std::unique_lock<std::mutex> lock(s.mtx);
+			s.room.wait(lock, [&] { return seq - s.next_to_write < max_in_flight; });
+		}
+		Push({ session, seq++, line });
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(s.mtx);
+		s.reading_done = true;
+		s.num_requests = seq;
+	}
+	s.ready.notify_one();
+	writer.join();
+}
+
+void QueryServer::Listen(UnixSocketListener& listener)
+{
+	while (true)
+	{
+		std::unique_ptr<Connection> conn = listener.Accept();
+		{
+			std::lock_guard<std::mutex> lock(sessions_mtx);
+			num_sessions++;
+		}
+		// detached so a finished client's thread is freed right away, the
+		// dtor waits on num_sessions instead of joining
+		std::thread([this](std::unique_ptr<Connection> c)
+		{
+			Serve(std::move(c));
+			std::lock_guard<std::mutex> lock(sessions_mtx);
+			num_sessions--;
+			sessions_done.notify_all();
+		}, std::move(conn)).detach();
+	}
+}
+
+void QueryServer::Push(Request req)
+{
+	{
+		std::unique_lock<std::mutex> lock(queue_mtx);
+		not_full.wait(lock, [this] { return queue.size() < max_pending; });
+		queue.push_back(std::move(req));
+	}
+	not_empty.notify_one();
+}
+
+bool QueryServer::Pop(Request& req)
+{
+	{
+		std::unique_lock<std::mutex> lock(queue_mtx);
+		not_empty.wait(lock, [this] { return stopping || !queue.empty(); });
+		if (queue.empty())
+		{
+			return false;
+		}
+		req = std::move(queue.front());
+		queue.pop_front();
+	}
+	not_full.notify_one();
+	return true;
+}
+
+void QueryServer::WorkerLoop()
+{
+	Request req;
+	while (Pop(req))
+	{
+		std::string answer = engine.Answer(req.line) + '\n';
+
+		Session& s = *req.session;
+		{
+			std::lock_guard<std::mutex> lock(s.mtx);
+			s.waiting.emplace(req.seq, std::move(answer));
+		}
+		s.ready.notify_one();
+		// don't keep the session alive while waiting for the next request
+		req.session.reset();
+	}
+}
+
+void QueryServer::WriterLoop(Session& s)
+{
+	std::unique_lock<std::mutex> lock(s.mtx);
+	while (true)
+	{
+		const auto next_ready = [&s]()
+		{
+			return !s.waiting.empty() && s.waiting.begin()->first == s.next_to_write;
+		};
+		s.ready.wait(lock, [&]()
+		{
+			return next_ready() || (s.reading_done && s.next_to_write == s.num_requests);
+		});
+		if (!next_ready())
+		{
+			return;
+		}
+		// every answer that is now next in line goes out in one write
+		std::string batch;
+		uint64_t count = 0;
+		for (auto it = s.waiting.begin(); it != s.waiting.end() && it->first == s.next_to_write + count; it = s.waiting.erase(it))
+		{
+			batch += it->second;
+			count++;
+		}
+		// the client may be slow to read, so workers must be able to add
+		// answers while this waits on the socket
+		lock.unlock();
+		s.conn->Write(batch);
+		lock.lock();
+		s.next_to_write += count;
+		s.room.notify_one();
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "Connection.h"
+#include "QueryEngine.h"
+#include "ThreadPool.h"
+
+// answers the requests of any num of clients on a pool of worker threads
+// every client's requests are read as fast as they arrive and queued, so a
+// client can send a whole batch without waiting, and answered in parallel,
+// the answers to one client are written back in the order it asked by a
+// writer thread of its own, so a client that is slow to read only holds up
+// itself and never the workers
+class QueryServer
+{
+	struct Session;
+	// a request line along with who asked and its position in their requests
+	struct Request
+	{
+		std::shared_ptr<Session> session;
+		uint64_t seq;
+		std::string line;
+	};
+
+public:
+	// answers with engine on num_threads threads, 0 for one per hardware
+	// thread, clients have to wait to send once max_pending requests are
+	// queued, or once max_in_flight of their own are yet to be written back
+	QueryServer(const QueryEngine& engine, size_t num_threads, size_t max_pending, size_t max_in_flight);
+	QueryServer(const QueryServer&) = delete;
+	QueryServer& operator=(const QueryServer&) = delete;
+	// waits for every client being served to finish
+	~QueryServer();
+
+	// serves one client until it stops sending (or sends quit) and every
+	// answer has been written
+	void Serve(std::unique_ptr<Connection> conn);
+	// serves every client that connects, each on a thread of its own
+	// returns only if accepting fails, by throwing
+	void Listen(UnixSocketListener& listener);
+
+private:
+	// adds a request, waiting while the queue is full
+	void Push(Request req);
+	// takes the oldest request, waiting while the queue is empty
+	// returns false once the server is stopping and nothing is left
+	bool Pop(Request& req);
+	// what every worker thread runs
+	void WorkerLoop();
+	// writes the answers to s in order until every request it sent is answered
+	void WriterLoop(Session& s);
+
+private:
+	const QueryEngine& engine;
+	const size_t max_pending;
+	const size_t max_in_flight;
+
+	std::mutex queue_mtx;
+	std::condition_variable not_empty;
+	std::condition_variable not_full;
+	std::deque<Request> queue;
+	bool stopping = false;
+
+	// clients served by Listen that haven't finished yet
+	std::mutex sessions_mtx;
+	std::condition_variable sessions_done;
+	size_t num_sessions = 0;
+
+	ThreadPool pool;
+	// runs the pool's workers until the server stops
+	std::thread workers;
+};